@@ -1,5 +1,6 @@
 #include "algos.h"
 
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,6 +12,11 @@
 #define XORSHIRO256PP_MAGIC_FIRST_NUMBER 0xbf58476d1ce4e5b9
 #define XORSHIRO256PP_MAGIC_SECOND_NUMBER 0x94d049bb133111eb
 #define DIV3_MAGIC_NUMBER 0xAAAAAAABULL
+#define MURMUR3_C1 0x87c37b91114253d5ULL
+#define MURMUR3_C2 0x4cf5ad432745937fULL
+#define MURMUR3_BLOCK_SIZE 16
+#define HISTOGRAM_TABLES 4
+#define HISTOGRAM_FLUSH (1u << 30)
 
 #define rot(x, k) (((x) << (k)) | ((x) >> (32 - (k))))
 
@@ -293,18 +299,63 @@ uint64_t wyrand() {
     return (t >> 64) ^ t;
 }
 
-void counting_sort_256(uint8_t* arr, size_t n) {
-    size_t count[256] = { 0 };
+// consecutive bytes go to different tables, so runs of one value do not chain increments of the
+// same counter through store-to-load forwarding; the 32-bit counters are flushed before overflow
+void byte_histogram(const uint8_t* data, size_t n, size_t count[256]) {
+    uint32_t tables[HISTOGRAM_TABLES][256];
+
+    memset(count, 0, 256 * sizeof(size_t));
+    while (n > 0) {
+        size_t chunk = n < HISTOGRAM_FLUSH ? n : HISTOGRAM_FLUSH;
+        size_t i = 0;
+
+        memset(tables, 0, sizeof(tables));
+        for (; i + 16 <= chunk; i += 16) {
+            uint64_t lo;
+            uint64_t hi;
+            memcpy(&lo, data + i, sizeof(lo));
+            memcpy(&hi, data + i + 8, sizeof(hi));
+#pragma GCC unroll 8
+            for (int k = 0; k < 8; k++) {
+                tables[k % HISTOGRAM_TABLES][(uint8_t)(lo >> (8 * k))]++;
+                tables[(k + 2) % HISTOGRAM_TABLES][(uint8_t)(hi >> (8 * k))]++;
+            }
+        }
+        for (; i < chunk; i++) {
+            tables[i % HISTOGRAM_TABLES][data[i]]++;
+        }
 
-    for (size_t i = 0; i < n; i++) {
-        count[arr[i]]++;
+        for (int c = 0; c < 256; c++) {
+            for (int t = 0; t < HISTOGRAM_TABLES; t++) {
+                count[c] += tables[t][c];
+            }
+        }
+        data += chunk;
+        n -= chunk;
     }
+}
+
+double byte_entropy(const size_t count[256], size_t n) {
+    double bits = 0.0;
+
+    for (int c = 0; c < 256; c++) {
+        if (count[c]) {
+            double p = (double)count[c] / n;
+            bits -= p * log2(p);
+        }
+    }
+    return bits;
+}
+
+void counting_sort_256(uint8_t* arr, size_t n) {
+    size_t count[256];
+
+    byte_histogram(arr, n, count);
 
     size_t idx = 0;
     for (size_t i = 0; i < 256; i++) {
-        while (count[i]--) {
-            arr[idx++] = i;
-        }
+        memset(arr + idx, (int)i, count[i]);
+        idx += count[i];
     }
 }
 
@@ -439,6 +490,22 @@ uint32_t fletcher32(const uint16_t* data, size_t len) {
     return sum2 << 16 | sum1;
 }
 
+// both sums are kept modulo 65535 with 0 represented as 0xffff, and the
+// 0xffff start value is that same zero, so chunk sums simply add up
+uint32_t fletcher32_combine(uint32_t sum1, uint32_t sum2, size_t len2) {
+    uint64_t a1 = (sum1 & 0xffff) % 65535;
+    uint64_t a2 = (sum1 >> 16) % 65535;
+    uint64_t b1 = (sum2 & 0xffff) % 65535;
+    uint64_t b2 = (sum2 >> 16) % 65535;
+
+    uint32_t s1 = (uint32_t)((a1 + b1) % 65535);
+    uint32_t s2 = (uint32_t)((a2 + (len2 % 65535) * a1 + b2) % 65535);
+
+    s1 = s1 ? s1 : 0xffff;
+    s2 = s2 ? s2 : 0xffff;
+    return s2 << 16 | s1;
+}
+
 uint32_t fletcher32_string(const char* str) {
     size_t len = strlen(str);
     size_t padded_len = (len + 1) / 2;
@@ -528,19 +595,6 @@ uint64_t ranq1() {
     return ranq1_state * 2685821657736338717ULL;
 }
 
-static inline uint64_t rotl64(uint64_t x, int8_t r) {
-    return (x << r) | (x >> (64 - r));
-}
-
-static inline uint64_t fmix64(uint64_t k) {
-    k ^= k >> 33;
-    k *= 0xff51afd7ed558ccdULL;
-    k ^= k >> 33;
-    k *= 0xc4ceb9fe1a85ec53ULL;
-    k ^= k >> 33;
-    return k;
-}
-
 void murmur3_prng_init(murmur3_prng_t* prng, uint64_t seed) {
     prng->seed = seed;
     prng->counter = 0;
@@ -567,6 +621,134 @@ uint64_t murmur3_prng_next(murmur3_prng_t* prng) {
     return h1;
 }
 
+static inline uint64_t murmur3_load64_partial(const uint8_t* p, size_t len) {
+    uint64_t k = 0;
+    for (size_t i = 0; i < len; i++) {
+        k |= (uint64_t)p[i] << (8 * i);
+    }
+    return k;
+}
+
+static void murmur3_x64_128_blocks(uint64_t* h1p, uint64_t* h2p, const uint8_t* data, size_t nblocks) {
+    uint64_t h1 = *h1p;
+    uint64_t h2 = *h2p;
+
+    for (size_t i = 0; i < nblocks; i++) {
+        uint64_t k1, k2;
+        memcpy(&k1, data + i * MURMUR3_BLOCK_SIZE, sizeof(k1));
+        memcpy(&k2, data + i * MURMUR3_BLOCK_SIZE + 8, sizeof(k2));
+
+        k1 *= MURMUR3_C1;
+        k1 = rotl64(k1, 31);
+        k1 *= MURMUR3_C2;
+        h1 ^= k1;
+
+        h1 = rotl64(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= MURMUR3_C2;
+        k2 = rotl64(k2, 33);
+        k2 *= MURMUR3_C1;
+        h2 ^= k2;
+
+        h2 = rotl64(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    *h1p = h1;
+    *h2p = h2;
+}
+
+static void murmur3_x64_128_finish(
+    uint64_t h1, uint64_t h2, const uint8_t* tail, size_t tail_len, size_t total_len, uint64_t out[2]) {
+    if (tail_len > 8) {
+        uint64_t k2 = murmur3_load64_partial(tail + 8, tail_len - 8);
+        k2 *= MURMUR3_C2;
+        k2 = rotl64(k2, 33);
+        k2 *= MURMUR3_C1;
+        h2 ^= k2;
+    }
+    if (tail_len > 0) {
+        uint64_t k1 = murmur3_load64_partial(tail, tail_len > 8 ? 8 : tail_len);
+        k1 *= MURMUR3_C1;
+        k1 = rotl64(k1, 31);
+        k1 *= MURMUR3_C2;
+        h1 ^= k1;
+    }
+
+    h1 ^= total_len;
+    h2 ^= total_len;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    out[0] = h1;
+    out[1] = h2;
+}
+
+void murmur3_x64_128(const void* key, size_t len, uint32_t seed, uint64_t out[2]) {
+    const uint8_t* data = (const uint8_t*)key;
+    size_t nblocks = len / MURMUR3_BLOCK_SIZE;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    murmur3_x64_128_blocks(&h1, &h2, data, nblocks);
+    murmur3_x64_128_finish(h1, h2, data + nblocks * MURMUR3_BLOCK_SIZE, len % MURMUR3_BLOCK_SIZE, len, out);
+}
+
+uint64_t murmur3_x64_64(const void* key, size_t len, uint32_t seed) {
+    uint64_t out[2];
+    murmur3_x64_128(key, len, seed, out);
+    return out[0];
+}
+
+void murmur3_x64_128_init(murmur3_x64_128_ctx* ctx, uint32_t seed) {
+    ctx->h1 = seed;
+    ctx->h2 = seed;
+    ctx->tail_len = 0;
+    ctx->total_len = 0;
+}
+
+void murmur3_x64_128_update(murmur3_x64_128_ctx* ctx, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    ctx->total_len += len;
+
+    if (ctx->tail_len) {
+        size_t take = MURMUR3_BLOCK_SIZE - ctx->tail_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->tail + ctx->tail_len, p, take);
+        ctx->tail_len += take;
+        p += take;
+        len -= take;
+
+        if (ctx->tail_len < MURMUR3_BLOCK_SIZE) {
+            return;
+        }
+        murmur3_x64_128_blocks(&ctx->h1, &ctx->h2, ctx->tail, 1);
+        ctx->tail_len = 0;
+    }
+
+    size_t nblocks = len / MURMUR3_BLOCK_SIZE;
+    murmur3_x64_128_blocks(&ctx->h1, &ctx->h2, p, nblocks);
+
+    ctx->tail_len = len % MURMUR3_BLOCK_SIZE;
+    memcpy(ctx->tail, p + nblocks * MURMUR3_BLOCK_SIZE, ctx->tail_len);
+}
+
+void murmur3_x64_128_final(murmur3_x64_128_ctx* ctx, uint64_t out[2]) {
+    murmur3_x64_128_finish(ctx->h1, ctx->h2, ctx->tail, ctx->tail_len, ctx->total_len, out);
+}
+
 double calculate_pi_leibniz(long long iterations) {
     double pi = 1.0;
     long long i;
@@ -36,6 +36,13 @@ typedef struct {
     uint64_t counter;
 } murmur3_prng_t;
 
+typedef struct {
+    uint64_t h1, h2;
+    uint8_t tail[16];
+    size_t tail_len;
+    size_t total_len;
+} murmur3_x64_128_ctx;
+
 /**
  * @brief xorshift64 pseudorandom generator
  *
@@ -184,6 +191,27 @@ uint32_t to_gray(uint32_t n);
  **/
 uint32_t from_gray(uint32_t gray);
 
+/**
+ * @brief Occurrences of every byte value
+ *
+ * Counts 16 bytes per iteration into 4 interleaved tables, which keeps skewed or run-heavy data
+ * from stalling on repeated increments of one counter.
+ *
+ * @param data
+ * @param n
+ * @param count 256 counters, overwritten
+ **/
+void byte_histogram(const uint8_t* data, size_t n, size_t count[256]);
+
+/**
+ * @brief Shannon entropy of a byte histogram
+ *
+ * @param count byte_histogram counters
+ * @param n total count
+ * @return double bits per byte, 0..8 (0 for n = 0)
+ **/
+double byte_entropy(const size_t count[256], size_t n);
+
 /**
  * @brief Counting sort for arrays with small range
  *
@@ -312,6 +340,16 @@ uint32_t tinymt32_generate(tinymt32_t* tmt);
  **/
 uint32_t fletcher32(const uint16_t* data, size_t len);
 
+/**
+ * @brief Combine fletcher32 checksums of two consecutive chunks
+ *
+ * @param sum1 fletcher32 of the first chunk
+ * @param sum2 fletcher32 of the second chunk
+ * @param len2 length of the second chunk in 16-bit words
+ * @return uint32_t fletcher32 of first || second
+ **/
+uint32_t fletcher32_combine(uint32_t sum1, uint32_t sum2, size_t len2);
+
 /**
  * @brief Get string checksum by fletcher32-algo
  *
@@ -366,14 +404,81 @@ uint32_t fnv1a_hash(const void* data, size_t len);
 
 uint32_t jsf32();
 
-static inline uint64_t rotl64(uint64_t x, int8_t r);
+/**
+ * @brief Rotate 64-bit number left
+ *
+ * @param x
+ * @param r
+ * @return uint64_t
+ **/
+static inline uint64_t rotl64(uint64_t x, int8_t r) {
+    return (x << r) | (x >> (64 - r));
+}
 
-static inline uint64_t fmix64(uint64_t k);
+/**
+ * @brief MurmurHash3 64-bit finalization mix (avalanches all bits)
+ *
+ * @param k
+ * @return uint64_t
+ **/
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
 
 void murmur3_prng_init(murmur3_prng_t* prng, uint64_t seed);
 
 uint64_t murmur3_prng_next(murmur3_prng_t* prng);
 
+/**
+ * @brief MurmurHash3 x64 128-bit hash
+ *
+ * @param key data
+ * @param len data length
+ * @param seed
+ * @param out two 64-bit halves of the hash (h1, h2)
+ **/
+void murmur3_x64_128(const void* key, size_t len, uint32_t seed, uint64_t out[2]);
+
+/**
+ * @brief MurmurHash3 x64 64-bit hash (first half of murmur3_x64_128)
+ *
+ * @param key data
+ * @param len data length
+ * @param seed
+ * @return uint64_t
+ **/
+uint64_t murmur3_x64_64(const void* key, size_t len, uint32_t seed);
+
+/**
+ * @brief Start streaming MurmurHash3 x64 128-bit hash
+ *
+ * @param ctx
+ * @param seed
+ **/
+void murmur3_x64_128_init(murmur3_x64_128_ctx* ctx, uint32_t seed);
+
+/**
+ * @brief Feed next chunk of data, chunks may have any size
+ *
+ * @param ctx
+ * @param data
+ * @param len
+ **/
+void murmur3_x64_128_update(murmur3_x64_128_ctx* ctx, const void* data, size_t len);
+
+/**
+ * @brief Finish streaming hash, result equals murmur3_x64_128 over all chunks
+ *
+ * @param ctx
+ * @param out two 64-bit halves of the hash (h1, h2)
+ **/
+void murmur3_x64_128_final(murmur3_x64_128_ctx* ctx, uint64_t out[2]);
+
 double calculate_pi_leibniz(long long iterations);
 
 #endif
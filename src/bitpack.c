@@ -0,0 +1,455 @@
+#include "bitpack.h"
+
+#include <emmintrin.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+// LEB128 needs at most 10 bytes for a 64-bit value
+#define BITPACK_VARINT_MAX 10
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+// one case per bit width, the 32-bit kernels are inlined with a constant width and fully unrolled
+#define BITPACK_WIDTHS8(X, n) X(n) X(n + 1) X(n + 2) X(n + 3) X(n + 4) X(n + 5) X(n + 6) X(n + 7)
+#define BITPACK_WIDTHS32(X) \
+    BITPACK_WIDTHS8(X, 0) BITPACK_WIDTHS8(X, 8) BITPACK_WIDTHS8(X, 16) BITPACK_WIDTHS8(X, 24) X(32)
+
+static size_t bitpack_put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static int bitpack_get_varint(const uint8_t* in, size_t len, size_t* pos, uint64_t* value) {
+    uint64_t result = 0;
+
+    for (unsigned shift = 0; shift < 7 * BITPACK_VARINT_MAX && *pos < len; shift += 7) {
+        uint8_t byte = in[(*pos)++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static inline size_t bitpack_varint_len(uint64_t value) {
+    return value ? (64 - __builtin_clzll(value) + 6) / 7 : 1;
+}
+
+// vector i holds values 4i..4i+3, lane l packs values l, l + 4, ... into width consecutive words
+static ALWAYS_INLINE void bitpack_pack32_kernel(const uint32_t* in, uint8_t* out, unsigned width) {
+    __m128i word = _mm_setzero_si128();
+    unsigned shift = 0;
+
+    if (width == 0) {
+        return;
+    }
+#pragma GCC unroll 32
+    for (int i = 0; i < 32; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)in + i);
+        word = _mm_or_si128(word, _mm_slli_epi32(v, shift));
+        shift += width;
+        if (shift >= 32) {
+            _mm_storeu_si128((__m128i*)out, word);
+            out += 16;
+            shift -= 32;
+            word = shift ? _mm_srli_epi32(v, width - shift) : _mm_setzero_si128();
+        }
+    }
+}
+
+// unpack, add the block minimum, undo zigzag and prefix-sum the deltas onto prev
+static ALWAYS_INLINE void bitpack_unpack32_kernel(
+    const uint8_t* in, uint32_t* out, unsigned width, uint32_t base, uint32_t prev) {
+    const __m128i mask = _mm_set1_epi32(width == 32 ? -1 : (int)((1u << (width & 31)) - 1));
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i vbase = _mm_set1_epi32((int)base);
+    __m128i sum = _mm_set1_epi32((int)prev);
+    __m128i word = width ? _mm_loadu_si128((const __m128i*)in) : _mm_setzero_si128();
+    unsigned shift = 0;
+
+#pragma GCC unroll 32
+    for (int i = 0; i < 32; i++) {
+        __m128i v = _mm_setzero_si128();
+        if (width) {
+            v = _mm_srli_epi32(word, shift);
+            shift += width;
+            if (shift >= 32) {
+                shift -= 32;
+                in += 16;
+                if (shift) {
+                    word = _mm_loadu_si128((const __m128i*)in);
+                    v = _mm_or_si128(v, _mm_slli_epi32(word, width - shift));
+                } else if (i < 31) {
+                    word = _mm_loadu_si128((const __m128i*)in);
+                }
+            }
+            v = _mm_and_si128(v, mask);
+        }
+        v = _mm_add_epi32(v, vbase);
+        v = _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, one)));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        sum = _mm_add_epi32(v, sum);
+        _mm_storeu_si128((__m128i*)out + i, sum);
+        sum = _mm_shuffle_epi32(sum, 0xff);
+    }
+}
+
+// 64-bit values: vector i holds values 2i, 2i+1, each lane packs 64 values into width words. The
+// width stays a runtime value here, 65 unrolled copies would outweigh the rest of the library.
+static void bitpack_pack64(const uint64_t* in, uint8_t* out, unsigned width) {
+    __m128i word = _mm_setzero_si128();
+    unsigned shift = 0;
+
+    if (width == 0) {
+        return;
+    }
+    for (int i = 0; i < 64; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)in + i);
+        word = _mm_or_si128(word, _mm_sll_epi64(v, _mm_cvtsi32_si128((int)shift)));
+        shift += width;
+        if (shift >= 64) {
+            _mm_storeu_si128((__m128i*)out, word);
+            out += 16;
+            shift -= 64;
+            word = shift ? _mm_srl_epi64(v, _mm_cvtsi32_si128((int)(width - shift))) : _mm_setzero_si128();
+        }
+    }
+}
+
+static void bitpack_unpack64(const uint8_t* in, uint64_t* out, unsigned width, uint64_t base, uint64_t prev) {
+    const __m128i mask = _mm_set1_epi64x(width == 64 ? -1 : (long long)((UINT64_C(1) << (width & 63)) - 1));
+    const __m128i one = _mm_set1_epi64x(1);
+    __m128i vbase = _mm_set1_epi64x((long long)base);
+    __m128i sum = _mm_set1_epi64x((long long)prev);
+    __m128i word = width ? _mm_loadu_si128((const __m128i*)in) : _mm_setzero_si128();
+    unsigned shift = 0;
+
+    for (int i = 0; i < 64; i++) {
+        __m128i v = _mm_setzero_si128();
+        if (width) {
+            v = _mm_srl_epi64(word, _mm_cvtsi32_si128((int)shift));
+            shift += width;
+            if (shift >= 64) {
+                shift -= 64;
+                in += 16;
+                if (shift) {
+                    word = _mm_loadu_si128((const __m128i*)in);
+                    v = _mm_or_si128(v, _mm_sll_epi64(word, _mm_cvtsi32_si128((int)(width - shift))));
+                } else if (i < 63) {
+                    word = _mm_loadu_si128((const __m128i*)in);
+                }
+            }
+            v = _mm_and_si128(v, mask);
+        }
+        v = _mm_add_epi64(v, vbase);
+        v = _mm_xor_si128(_mm_srli_epi64(v, 1), _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(v, one)));
+        v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+        sum = _mm_add_epi64(v, sum);
+        _mm_storeu_si128((__m128i*)out + i, sum);
+        sum = _mm_unpackhi_epi64(sum, sum);
+    }
+}
+
+#define BITPACK_PACK32_CASE(w)                   \
+    case w:                                      \
+        bitpack_pack32_kernel(in, out, w);       \
+        return;
+#define BITPACK_UNPACK32_CASE(w)                                \
+    case w:                                                     \
+        bitpack_unpack32_kernel(in, out, w, base, prev);        \
+        return;
+
+static void bitpack_pack32(const uint32_t* in, uint8_t* out, unsigned width) {
+    switch (width) {
+        BITPACK_WIDTHS32(BITPACK_PACK32_CASE)
+    }
+}
+
+static void bitpack_unpack32(const uint8_t* in, uint32_t* out, unsigned width, uint32_t base, uint32_t prev) {
+    switch (width) {
+        BITPACK_WIDTHS32(BITPACK_UNPACK32_CASE)
+    }
+}
+
+size_t bitpack_bound32(size_t n) {
+    return BITPACK_VARINT_MAX + (n / BITPACK_BLOCK + 1) * (1 + 5) + n * 5;
+}
+
+size_t bitpack_bound64(size_t n) {
+    return BITPACK_VARINT_MAX + (n / BITPACK_BLOCK + 1) * (1 + BITPACK_VARINT_MAX) + n * BITPACK_VARINT_MAX;
+}
+
+// zigzag deltas above the block minimum, packed when 128 of them at the common width are smallest
+static size_t bitpack_block32(const uint32_t* input, size_t count, uint32_t* prev, uint8_t* out) {
+    uint32_t z[BITPACK_BLOCK];
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    size_t varint_bytes = 0;
+    size_t pos = 1;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t d = input[i] - *prev;
+        *prev = input[i];
+        z[i] = (d << 1) ^ (uint32_t)((int32_t)d >> 31);
+        min = z[i] < min ? z[i] : min;
+        max = z[i] > max ? z[i] : max;
+    }
+    for (size_t i = 0; i < count; i++) {
+        z[i] -= min;
+        varint_bytes += bitpack_varint_len(z[i]);
+    }
+
+    unsigned width = max == min ? 0 : 32 - __builtin_clz(max - min);
+    pos += bitpack_put_varint(out + pos, min);
+    if (count == BITPACK_BLOCK && 16 * width <= varint_bytes) {
+        out[0] = (uint8_t)width;
+        bitpack_pack32(z, out + pos, width);
+        return pos + 16 * width;
+    }
+
+    out[0] = BITPACK_VARINT;
+    for (size_t i = 0; i < count; i++) {
+        pos += bitpack_put_varint(out + pos, z[i]);
+    }
+    return pos;
+}
+
+static size_t bitpack_block64(const uint64_t* input, size_t count, uint64_t* prev, uint8_t* out) {
+    uint64_t z[BITPACK_BLOCK];
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+    size_t varint_bytes = 0;
+    size_t pos = 1;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t d = input[i] - *prev;
+        *prev = input[i];
+        z[i] = (d << 1) ^ (uint64_t)((int64_t)d >> 63);
+        min = z[i] < min ? z[i] : min;
+        max = z[i] > max ? z[i] : max;
+    }
+    for (size_t i = 0; i < count; i++) {
+        z[i] -= min;
+        varint_bytes += bitpack_varint_len(z[i]);
+    }
+
+    unsigned width = max == min ? 0 : 64 - __builtin_clzll(max - min);
+    pos += bitpack_put_varint(out + pos, min);
+    if (count == BITPACK_BLOCK && 16 * width <= varint_bytes) {
+        out[0] = (uint8_t)width;
+        bitpack_pack64(z, out + pos, width);
+        return pos + 16 * width;
+    }
+
+    out[0] = BITPACK_VARINT;
+    for (size_t i = 0; i < count; i++) {
+        pos += bitpack_put_varint(out + pos, z[i]);
+    }
+    return pos;
+}
+
+int bitpack_encode32(const uint32_t* input, size_t n, uint8_t* output, size_t capacity, size_t* written) {
+    // a block is built in scratch space first unless its worst case fits into the output
+    uint8_t scratch[1 + 5 + BITPACK_BLOCK * 5];
+    uint8_t header[BITPACK_VARINT_MAX];
+    uint32_t prev = 0;
+    size_t pos;
+
+    *written = 0;
+    pos = bitpack_put_varint(header, n);
+    if (capacity < pos) {
+        errno = ENOSPC;
+        return -1;
+    }
+    memcpy(output, header, pos);
+
+    for (size_t i = 0; i < n; i += BITPACK_BLOCK) {
+        size_t count = n - i < BITPACK_BLOCK ? n - i : BITPACK_BLOCK;
+        if (capacity - pos >= sizeof(scratch)) {
+            pos += bitpack_block32(input + i, count, &prev, output + pos);
+            continue;
+        }
+        size_t len = bitpack_block32(input + i, count, &prev, scratch);
+        if (capacity - pos < len) {
+            errno = ENOSPC;
+            return -1;
+        }
+        memcpy(output + pos, scratch, len);
+        pos += len;
+    }
+
+    *written = pos;
+    return 0;
+}
+
+int bitpack_encode64(const uint64_t* input, size_t n, uint8_t* output, size_t capacity, size_t* written) {
+    uint8_t scratch[1 + BITPACK_VARINT_MAX + BITPACK_BLOCK * BITPACK_VARINT_MAX];
+    uint8_t header[BITPACK_VARINT_MAX];
+    uint64_t prev = 0;
+    size_t pos;
+
+    *written = 0;
+    pos = bitpack_put_varint(header, n);
+    if (capacity < pos) {
+        errno = ENOSPC;
+        return -1;
+    }
+    memcpy(output, header, pos);
+
+    for (size_t i = 0; i < n; i += BITPACK_BLOCK) {
+        size_t count = n - i < BITPACK_BLOCK ? n - i : BITPACK_BLOCK;
+        if (capacity - pos >= sizeof(scratch)) {
+            pos += bitpack_block64(input + i, count, &prev, output + pos);
+            continue;
+        }
+        size_t len = bitpack_block64(input + i, count, &prev, scratch);
+        if (capacity - pos < len) {
+            errno = ENOSPC;
+            return -1;
+        }
+        memcpy(output + pos, scratch, len);
+        pos += len;
+    }
+
+    *written = pos;
+    return 0;
+}
+
+int bitpack_count(const uint8_t* input, size_t len, size_t* n) {
+    size_t pos = 0;
+    uint64_t count;
+
+    if (bitpack_get_varint(input, len, &pos, &count) < 0 || count > SIZE_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    *n = (size_t)count;
+    return 0;
+}
+
+int bitpack_decode32(const uint8_t* input, size_t len, uint32_t* output, size_t capacity, size_t* n) {
+    size_t pos = 0;
+    uint64_t count;
+    uint32_t prev = 0;
+
+    *n = 0;
+    if (bitpack_get_varint(input, len, &pos, &count) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (count > capacity) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i += BITPACK_BLOCK) {
+        size_t block = count - i < BITPACK_BLOCK ? count - i : BITPACK_BLOCK;
+        uint64_t base;
+
+        if (pos == len) {
+            errno = EINVAL;
+            return -1;
+        }
+        unsigned width = input[pos++];
+        if (bitpack_get_varint(input, len, &pos, &base) < 0 || base > UINT32_MAX) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        if (width == BITPACK_VARINT) {
+            for (size_t j = 0; j < block; j++) {
+                uint64_t v;
+                if (bitpack_get_varint(input, len, &pos, &v) < 0 || v > UINT32_MAX) {
+                    errno = EINVAL;
+                    return -1;
+                }
+                uint32_t z = (uint32_t)v + (uint32_t)base;
+                prev += (z >> 1) ^ (0u - (z & 1));
+                output[i + j] = prev;
+            }
+            continue;
+        }
+        if (width > 32 || block != BITPACK_BLOCK || len - pos < 16 * width) {
+            errno = EINVAL;
+            return -1;
+        }
+        bitpack_unpack32(input + pos, output + i, width, (uint32_t)base, prev);
+        pos += 16 * width;
+        prev = output[i + BITPACK_BLOCK - 1];
+    }
+
+    if (pos != len) {
+        errno = EINVAL;
+        return -1;
+    }
+    *n = (size_t)count;
+    return 0;
+}
+
+int bitpack_decode64(const uint8_t* input, size_t len, uint64_t* output, size_t capacity, size_t* n) {
+    size_t pos = 0;
+    uint64_t count;
+    uint64_t prev = 0;
+
+    *n = 0;
+    if (bitpack_get_varint(input, len, &pos, &count) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (count > capacity) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i += BITPACK_BLOCK) {
+        size_t block = count - i < BITPACK_BLOCK ? count - i : BITPACK_BLOCK;
+        uint64_t base;
+
+        if (pos == len) {
+            errno = EINVAL;
+            return -1;
+        }
+        unsigned width = input[pos++];
+        if (bitpack_get_varint(input, len, &pos, &base) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        if (width == BITPACK_VARINT) {
+            for (size_t j = 0; j < block; j++) {
+                uint64_t z;
+                if (bitpack_get_varint(input, len, &pos, &z) < 0) {
+                    errno = EINVAL;
+                    return -1;
+                }
+                z += base;
+                prev += (z >> 1) ^ (0 - (z & 1));
+                output[i + j] = prev;
+            }
+            continue;
+        }
+        if (width > 64 || block != BITPACK_BLOCK || len - pos < 16 * width) {
+            errno = EINVAL;
+            return -1;
+        }
+        bitpack_unpack64(input + pos, output + i, width, base, prev);
+        pos += 16 * width;
+        prev = output[i + BITPACK_BLOCK - 1];
+    }
+
+    if (pos != len) {
+        errno = EINVAL;
+        return -1;
+    }
+    *n = (size_t)count;
+    return 0;
+}
@@ -0,0 +1,94 @@
+#ifndef BITPACK_H
+#define BITPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BITPACK_BLOCK 128
+// block descriptor of a varint coded block, other values are the bit width
+#define BITPACK_VARINT 0xff
+
+/**
+ * @brief Worst-case size of bitpack_encode32 output
+ *
+ * @param n number of values
+ * @return size_t
+ **/
+size_t bitpack_bound32(size_t n);
+
+/**
+ * @brief Worst-case size of bitpack_encode64 output
+ *
+ * @param n number of values
+ * @return size_t
+ **/
+size_t bitpack_bound64(size_t n);
+
+/**
+ * @brief Compress integer array: delta, zigzag, then frame-of-reference bit-packing per block
+ *
+ * Output: LEB128 count, then one block per BITPACK_BLOCK values (the last may be shorter). A block
+ * is a descriptor byte, the LEB128 block minimum of the zigzag deltas and either 128 values of that
+ * many bits above the minimum, packed 4 lanes wide (value i in lane i % 4), or one varint per
+ * value when that is smaller (outliers, the short last block). Sorted or slowly varying columns
+ * shrink to a few bits per value.
+ *
+ * @param input
+ * @param n number of values
+ * @param output
+ * @param capacity output size, bitpack_bound32(n) always suffices
+ * @param written encoded length
+ * @return int 0 on success, -1 with errno ENOSPC if output is too small
+ **/
+int bitpack_encode32(const uint32_t* input, size_t n, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief bitpack_encode32 for 64-bit values, packed 2 lanes wide
+ *
+ * @param input
+ * @param n number of values
+ * @param output
+ * @param capacity output size, bitpack_bound64(n) always suffices
+ * @param written encoded length
+ * @return int 0 on success, -1 with errno ENOSPC if output is too small
+ **/
+int bitpack_encode64(const uint64_t* input, size_t n, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Number of values in bitpack_encode32/64 output, from the header only
+ *
+ * @param input
+ * @param len
+ * @param n
+ * @return int 0 on success, -1 with errno EINVAL on malformed input
+ **/
+int bitpack_count(const uint8_t* input, size_t len, size_t* n);
+
+/**
+ * @brief Decode bitpack_encode32 output
+ *
+ * Packed blocks are unpacked by an SSE2 kernel specialized for their bit width, which also adds
+ * the minimum back, undoes zigzag and runs the delta prefix sum 4 values at a time.
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size in values
+ * @param n number of values decoded
+ * @return int 0 on success, -1 with errno EINVAL on malformed input or ENOSPC if output is too small
+ **/
+int bitpack_decode32(const uint8_t* input, size_t len, uint32_t* output, size_t capacity, size_t* n);
+
+/**
+ * @brief Decode bitpack_encode64 output
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size in values
+ * @param n number of values decoded
+ * @return int 0 on success, -1 with errno EINVAL on malformed input or ENOSPC if output is too small
+ **/
+int bitpack_decode64(const uint8_t* input, size_t len, uint64_t* output, size_t capacity, size_t* n);
+
+#endif    // BITPACK_H
@@ -0,0 +1,58 @@
+#include "bloom.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline uint64_t bloom_bit(const bloom_filter_t* bf, uint64_t hash, uint32_t i) {
+    uint64_t g = (hash >> 32) + i * ((hash & 0xffffffffULL) | 1);
+    return (uint64_t)(((unsigned __int128)(g * 0x9e3779b97f4a7c15ULL) * bf->num_bits) >> 64);
+}
+
+int bloom_init(bloom_filter_t* bf, size_t capacity, double fpr) {
+    memset(bf, 0, sizeof(*bf));
+    if (capacity == 0 || fpr <= 0.0 || fpr >= 1.0) {
+        return -1;
+    }
+
+    // m = -n ln p / ln^2 2, k = m / n * ln 2
+    const double ln2 = log(2.0);
+    double bits = -(double)capacity * log(fpr) / (ln2 * ln2);
+    uint64_t words = (uint64_t)ceil(bits / 64.0);
+    uint32_t k = (uint32_t)lround(bits / (double)capacity * ln2);
+
+    bf->bits = calloc(words, sizeof(uint64_t));
+    if (!bf->bits) {
+        return -1;
+    }
+    bf->num_bits = words * 64;
+    bf->k = k ? k : 1;
+    return 0;
+}
+
+void bloom_free(bloom_filter_t* bf) {
+    free(bf->bits);
+    memset(bf, 0, sizeof(*bf));
+}
+
+void bloom_add_hash(bloom_filter_t* bf, uint64_t hash) {
+    for (uint32_t i = 0; i < bf->k; i++) {
+        uint64_t bit = bloom_bit(bf, hash, i);
+        bf->bits[bit >> 6] |= UINT64_C(1) << (bit & 63);
+    }
+}
+
+int bloom_contains_hash(const bloom_filter_t* bf, uint64_t hash) {
+    for (uint32_t i = 0; i < bf->k; i++) {
+        uint64_t bit = bloom_bit(bf, hash, i);
+        if (!(bf->bits[bit >> 6] & (UINT64_C(1) << (bit & 63)))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+size_t bloom_memory(const bloom_filter_t* bf) {
+    return bf->num_bits / 8;
+}
@@ -0,0 +1,62 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Bloom filter over one 64-bit hash, probe i sets bit h1 + i * h2 (no deletion)
+ *
+ * @param bits
+ * @param num_bits multiple of 64
+ * @param k probes per item
+ **/
+typedef struct {
+    uint64_t* bits;
+    uint64_t num_bits;
+    uint32_t k;
+} bloom_filter_t;
+
+/**
+ * @brief Initialize empty filter with the optimal size for capacity items at false positive rate fpr
+ *
+ * @param bf
+ * @param capacity
+ * @param fpr target false positive rate, 0 < fpr < 1
+ * @return int 0 on success, -1 on invalid parameters or allocation error
+ **/
+int bloom_init(bloom_filter_t* bf, size_t capacity, double fpr);
+
+/**
+ * @brief Free filter
+ *
+ * @param bf
+ **/
+void bloom_free(bloom_filter_t* bf);
+
+/**
+ * @brief Add 64-bit hash
+ *
+ * @param bf
+ * @param hash
+ **/
+void bloom_add_hash(bloom_filter_t* bf, uint64_t hash);
+
+/**
+ * @brief Test 64-bit hash
+ *
+ * @param bf
+ * @param hash
+ * @return int 1 if possibly present, 0 if absent
+ **/
+int bloom_contains_hash(const bloom_filter_t* bf, uint64_t hash);
+
+/**
+ * @brief Memory used by the filter in bytes
+ *
+ * @param bf
+ * @return size_t
+ **/
+size_t bloom_memory(const bloom_filter_t* bf);
+
+#endif    // BLOOM_H
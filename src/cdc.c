@@ -0,0 +1,139 @@
+#include "cdc.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "algos.h"
+
+// normalization level: strict mask has 2 bits more than log2(avg), loose mask 2 bits less
+#define CDC_NORMALIZATION 2
+#define CDC_MIN_READ_BUFFER (1u << 20)
+
+// mask on the top bits: they depend on the last 64 bytes, low bits only on the last few
+static uint64_t cdc_top_mask(int bits) {
+    return bits >= 64 ? ~0ULL : ((1ULL << bits) - 1) << (64 - bits);
+}
+
+int cdc_init(cdc_params_t* params, size_t min_size, size_t avg_size, size_t max_size, uint64_t seed) {
+    if (avg_size < 64 || (avg_size & (avg_size - 1)) || min_size > avg_size || max_size < avg_size) {
+        return -1;
+    }
+
+    xoshiro256pp_state rng;
+    xoshiro256pp_init(&rng, seed);
+    for (int i = 0; i < 256; i++) {
+        params->gear[i] = xoshiro256pp_next(&rng);
+    }
+
+    int bits = __builtin_ctzll(avg_size);
+    params->min_size = min_size;
+    params->avg_size = avg_size;
+    params->max_size = max_size;
+    params->mask_s = cdc_top_mask(bits + CDC_NORMALIZATION);
+    params->mask_l = cdc_top_mask(bits - CDC_NORMALIZATION);
+    return 0;
+}
+
+size_t cdc_next_boundary(const cdc_params_t* params, const uint8_t* data, size_t len) {
+    const uint64_t* gear = params->gear;
+    uint64_t fp = 0;
+
+    if (len <= params->min_size) {
+        return len;
+    }
+    if (len > params->max_size) {
+        len = params->max_size;
+    }
+
+    size_t barrier = len < params->avg_size ? len : params->avg_size;
+    size_t i = params->min_size;
+
+    for (; i < barrier; i++) {
+        fp = (fp << 1) + gear[data[i]];
+        if (!(fp & params->mask_s)) {
+            return i + 1;
+        }
+    }
+
+    for (; i < len; i++) {
+        fp = (fp << 1) + gear[data[i]];
+        if (!(fp & params->mask_l)) {
+            return i + 1;
+        }
+    }
+    return len;
+}
+
+static void cdc_emit(cdc_chunk_fn fn, void* ctx, uint64_t offset, const uint8_t* data, size_t len) {
+    if (fn) {
+        uint64_t hash[2];
+        murmur3_x64_128(data, len, 0, hash);
+        fn(ctx, offset, data, len, hash);
+    }
+}
+
+size_t cdc_chunk_buffer(
+    const cdc_params_t* params, const uint8_t* data, size_t len, cdc_chunk_fn fn, void* ctx) {
+    size_t pos = 0;
+    size_t count = 0;
+
+    while (pos < len) {
+        size_t n = cdc_next_boundary(params, data + pos, len - pos);
+        cdc_emit(fn, ctx, pos, data + pos, n);
+        pos += n;
+        count++;
+    }
+    return count;
+}
+
+int cdc_chunk_fd(const cdc_params_t* params, int fd, cdc_chunk_fn fn, void* ctx, size_t* nchunks) {
+    size_t cap = params->max_size * 4 > CDC_MIN_READ_BUFFER ? params->max_size * 4 : CDC_MIN_READ_BUFFER;
+    uint8_t* buf = malloc(cap);
+    if (!buf) {
+        return -1;
+    }
+
+    uint64_t offset = 0;
+    size_t have = 0;
+    size_t count = 0;
+    int eof = 0;
+
+    while (!eof) {
+        while (!eof && have < cap) {
+            ssize_t r = read(fd, buf + have, cap - have);
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                int err = errno;
+                free(buf);
+                errno = err;
+                return -1;
+            }
+            if (r == 0) {
+                eof = 1;
+            }
+            have += (size_t)r;
+        }
+
+        // without a full max_size window a cut point could still move, keep the tail for later
+        size_t pos = 0;
+        while (have - pos >= params->max_size || (eof && pos < have)) {
+            size_t n = cdc_next_boundary(params, buf + pos, have - pos);
+            cdc_emit(fn, ctx, offset, buf + pos, n);
+            offset += n;
+            pos += n;
+            count++;
+        }
+
+        memmove(buf, buf + pos, have - pos);
+        have -= pos;
+    }
+
+    free(buf);
+    *nchunks = count;
+    return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef CDC_H
+#define CDC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CDC_DEFAULT_SEED 0x9e3779b97f4a7c15ULL
+#define CDC_DEFAULT_MIN_SIZE 2048
+#define CDC_DEFAULT_AVG_SIZE 8192
+#define CDC_DEFAULT_MAX_SIZE 65536
+
+/**
+ * @brief FastCDC chunker parameters
+ *
+ * @param gear random 64-bit value per byte, rolled into the fingerprint
+ * @param min_size no cut point before this size
+ * @param avg_size expected chunk size, switches from strict to loose mask
+ * @param max_size forced cut point
+ * @param mask_s strict mask (more bits) used below avg_size
+ * @param mask_l loose mask (fewer bits) used above avg_size
+ */
+typedef struct {
+    uint64_t gear[256];
+    size_t min_size;
+    size_t avg_size;
+    size_t max_size;
+    uint64_t mask_s;
+    uint64_t mask_l;
+} cdc_params_t;
+
+/**
+ * @brief Chunk callback
+ *
+ * @param ctx user context
+ * @param offset chunk offset in the stream
+ * @param data chunk bytes (valid only during the call)
+ * @param len chunk length
+ * @param hash murmur3_x64_128 of the chunk
+ */
+typedef void (*cdc_chunk_fn)(
+    void* ctx, uint64_t offset, const uint8_t* data, size_t len, const uint64_t hash[2]);
+
+/**
+ * @brief Initialize chunker, gear table is filled by xoshiro256pp
+ *
+ * @param params
+ * @param min_size
+ * @param avg_size power of two
+ * @param max_size
+ * @param seed gear table seed (CDC_DEFAULT_SEED for stable boundaries)
+ * @return int 0 on success, -1 on invalid sizes
+ **/
+int cdc_init(cdc_params_t* params, size_t min_size, size_t avg_size, size_t max_size, uint64_t seed);
+
+/**
+ * @brief Find the first content-defined cut point
+ *
+ * @param params
+ * @param data
+ * @param len available bytes, should be >= max_size unless it is the end of stream
+ * @return size_t length of the first chunk
+ **/
+size_t cdc_next_boundary(const cdc_params_t* params, const uint8_t* data, size_t len);
+
+/**
+ * @brief Split a memory buffer (e.g. mmapped file) into chunks
+ *
+ * @param params
+ * @param data
+ * @param len
+ * @param fn called for each chunk, may be NULL to only count chunks
+ * @param ctx
+ * @return size_t number of chunks
+ **/
+size_t cdc_chunk_buffer(
+    const cdc_params_t* params, const uint8_t* data, size_t len, cdc_chunk_fn fn, void* ctx);
+
+/**
+ * @brief Split a stream read from file descriptor into chunks, memory use is O(max_size)
+ *
+ * @param params
+ * @param fd
+ * @param fn called for each chunk, may be NULL to only count chunks
+ * @param ctx
+ * @param nchunks number of chunks
+ * @return int 0 on success, -1 on read or allocation error (errno is set)
+ **/
+int cdc_chunk_fd(const cdc_params_t* params, int fd, cdc_chunk_fn fn, void* ctx, size_t* nchunks);
+
+#endif    // CDC_H
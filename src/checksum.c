@@ -0,0 +1,214 @@
+#include "checksum.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "algos.h"
+#include "crc32c.h"
+#include "threadpool.h"
+
+// 16-bit words fletcher32_bytes copies per step for unaligned input
+#define FLETCHER32_COPY_WORDS 2048
+
+typedef struct {
+    checksum_algo_t algo;
+    const uint8_t* data;
+    size_t len;
+    size_t nchunks;
+    int release_pages;
+    uint32_t* partial;
+} checksum_job_t;
+
+static const char* const checksum_names[] = {
+    [CHECKSUM_FLETCHER32] = "fletcher32",
+    [CHECKSUM_CRC32C] = "crc32c",
+    [CHECKSUM_FNV1A] = "fnv1a",
+    [CHECKSUM_JENKINS] = "jenkins",
+    [CHECKSUM_MURMUR3] = "murmur3",
+};
+
+int checksum_algo_from_name(const char* name, checksum_algo_t* algo) {
+    for (size_t i = 0; i < sizeof(checksum_names) / sizeof(checksum_names[0]); i++) {
+        if (strcmp(name, checksum_names[i]) == 0) {
+            *algo = (checksum_algo_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* checksum_algo_name(checksum_algo_t algo) {
+    return checksum_names[algo];
+}
+
+int checksum_algo_is_parallel(checksum_algo_t algo) {
+    return algo == CHECKSUM_FLETCHER32 || algo == CHECKSUM_CRC32C;
+}
+
+// fletcher32 loads whole 16-bit words, blocks at odd offsets go through an aligned stack copy
+static uint32_t fletcher32_bytes(const uint8_t* data, size_t len) {
+    size_t words = len / 2;
+    uint32_t sum;
+
+    if (((uintptr_t)data & 1) == 0) {
+        sum = fletcher32((const uint16_t*)data, words);
+    } else {
+        uint16_t copy[FLETCHER32_COPY_WORDS];
+        sum = 0xffffffff;    // fletcher32 of no words
+        for (size_t first = 0; first < words; first += FLETCHER32_COPY_WORDS) {
+            size_t count = words - first < FLETCHER32_COPY_WORDS ? words - first : FLETCHER32_COPY_WORDS;
+            memcpy(copy, data + 2 * first, count * sizeof(uint16_t));
+            sum = fletcher32_combine(sum, fletcher32(copy, count), count);
+        }
+    }
+
+    if (len & 1) {
+        uint16_t last = data[len - 1];
+        sum = fletcher32_combine(sum, fletcher32(&last, 1), 1);
+    }
+    return sum;
+}
+
+uint32_t checksum_sum32(checksum_algo_t algo, const uint8_t* data, size_t len) {
+    return algo == CHECKSUM_FLETCHER32 ? fletcher32_bytes(data, len) : crc32c(0, data, len);
+}
+
+static inline size_t checksum_chunk_len(const checksum_job_t* job, size_t task) {
+    size_t offset = task * CHECKSUM_CHUNK_SIZE;
+    return job->len - offset < CHECKSUM_CHUNK_SIZE ? job->len - offset : CHECKSUM_CHUNK_SIZE;
+}
+
+static void checksum_chunk_task(void* ctx, size_t task) {
+    checksum_job_t* job = (checksum_job_t*)ctx;
+    const uint8_t* chunk = job->data + task * CHECKSUM_CHUNK_SIZE;
+    size_t len = checksum_chunk_len(job, task);
+
+    if (job->algo == CHECKSUM_FLETCHER32) {
+        job->partial[task] = fletcher32_bytes(chunk, len);
+    } else {
+        job->partial[task] = crc32c(0, chunk, len);
+    }
+
+    // file pages are not needed any more, keep resident memory flat on huge inputs
+    if (job->release_pages) {
+        madvise((void*)chunk, len, MADV_DONTNEED);
+    }
+}
+
+static void checksum_parallel(checksum_job_t* job, unsigned nthreads, checksum_result_t* result) {
+    // checksums of empty input
+    uint32_t sum = job->algo == CHECKSUM_FLETCHER32 ? 0xffffffffu : 0;
+
+    job->partial = malloc(job->nchunks * sizeof(uint32_t));
+    if (!job->partial) {
+        // no room for per-chunk sums: fall back to one pass
+        result->value[0] = job->algo == CHECKSUM_FLETCHER32 ? fletcher32_bytes(job->data, job->len)
+                                                            : crc32c(0, job->data, job->len);
+        return;
+    }
+
+    result->threads = threadpool_run(job->nchunks, checksum_chunk_task, job, nthreads);
+
+    for (size_t i = 0; i < job->nchunks; i++) {
+        size_t len = checksum_chunk_len(job, i);
+
+        if (job->algo == CHECKSUM_FLETCHER32) {
+            sum = fletcher32_combine(sum, job->partial[i], (len + 1) / 2);
+        } else {
+            sum = crc32c_combine(sum, job->partial[i], len);
+        }
+    }
+
+    free(job->partial);
+    result->value[0] = sum;
+}
+
+static void checksum_run(
+    checksum_algo_t algo,
+    const uint8_t* data,
+    size_t len,
+    unsigned nthreads,
+    int release_pages,
+    checksum_result_t* result) {
+    checksum_job_t job = {
+        .algo = algo,
+        .data = data,
+        .len = len,
+        .nchunks = (len + CHECKSUM_CHUNK_SIZE - 1) / CHECKSUM_CHUNK_SIZE,
+        .release_pages = release_pages,
+        .partial = NULL,
+    };
+
+    result->value[0] = 0;
+    result->value[1] = 0;
+    result->bits = algo == CHECKSUM_MURMUR3 ? 128 : 32;
+    result->threads = 1;
+
+    switch (algo) {
+        case CHECKSUM_FLETCHER32:
+        case CHECKSUM_CRC32C:
+            checksum_parallel(&job, nthreads, result);
+            break;
+        case CHECKSUM_FNV1A:
+            result->value[0] = fnv1a_hash(data, len);
+            break;
+        case CHECKSUM_JENKINS:
+            result->value[0] = jenkins_hash(data, len, 0);
+            break;
+        case CHECKSUM_MURMUR3:
+            murmur3_x64_128(data, len, 0, result->value);
+            break;
+    }
+}
+
+void checksum_buffer(
+    checksum_algo_t algo, const uint8_t* data, size_t len, unsigned nthreads, checksum_result_t* result) {
+    checksum_run(algo, data, len, nthreads, 0, result);
+}
+
+int checksum_file(
+    const char* path, checksum_algo_t algo, unsigned nthreads, checksum_result_t* result, size_t* file_size) {
+    static const uint8_t empty[1] = { 0 };
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    *file_size = size;
+
+    if (size == 0) {
+        close(fd);
+        checksum_run(algo, empty, 0, nthreads, 0, result);
+        return 0;
+    }
+
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        errno = err;
+        return -1;
+    }
+
+    madvise(map, size, MADV_SEQUENTIAL);
+    checksum_run(algo, (const uint8_t*)map, size, nthreads, 1, result);
+    munmap(map, size);
+
+    return 0;
+}
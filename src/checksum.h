@@ -0,0 +1,96 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// bytes per parallel task, kept even so fletcher32 words never straddle chunks
+#define CHECKSUM_CHUNK_SIZE (4u << 20)
+
+typedef enum {
+    CHECKSUM_FLETCHER32,
+    CHECKSUM_CRC32C,
+    CHECKSUM_FNV1A,
+    CHECKSUM_JENKINS,
+    CHECKSUM_MURMUR3,
+} checksum_algo_t;
+
+/**
+ * @brief Checksum value, 32-bit sums live in value[0]
+ *
+ * @param value checksum (murmur3 uses both halves)
+ * @param bits checksum width in bits
+ * @param threads number of workers that actually ran
+ **/
+typedef struct {
+    uint64_t value[2];
+    int bits;
+    unsigned threads;
+} checksum_result_t;
+
+/**
+ * @brief Parse algorithm name (fletcher32, crc32c, fnv1a, jenkins, murmur3)
+ *
+ * @param name
+ * @param algo parsed algorithm
+ * @return int 0 on success, -1 on unknown name
+ **/
+int checksum_algo_from_name(const char* name, checksum_algo_t* algo);
+
+/**
+ * @brief Get algorithm name
+ *
+ * @param algo
+ * @return const char*
+ **/
+const char* checksum_algo_name(checksum_algo_t algo);
+
+/**
+ * @brief Check that per-chunk results of the algorithm can be combined
+ *
+ * Combinable sums (fletcher32, crc32c) run chunks on the thread pool,
+ * chained hashes are computed in a single sequential pass.
+ *
+ * @param algo
+ * @return int
+ **/
+int checksum_algo_is_parallel(checksum_algo_t algo);
+
+/**
+ * @brief Single-threaded 32-bit checksum of a small buffer (e.g. one block of a container)
+ *
+ * @param algo CHECKSUM_FLETCHER32 or CHECKSUM_CRC32C
+ * @param data
+ * @param len
+ * @return uint32_t
+ **/
+uint32_t checksum_sum32(checksum_algo_t algo, const uint8_t* data, size_t len);
+
+/**
+ * @brief Checksum a memory buffer, in parallel when the algorithm allows it
+ *
+ * fletcher32 treats data as little-endian 16-bit words, odd tail is zero padded.
+ *
+ * @param algo
+ * @param data
+ * @param len
+ * @param nthreads number of workers (0 = all CPUs)
+ * @param result
+ **/
+void checksum_buffer(
+    checksum_algo_t algo, const uint8_t* data, size_t len, unsigned nthreads, checksum_result_t* result);
+
+/**
+ * @brief Memory-map a file and checksum it
+ *
+ * @param path
+ * @param algo
+ * @param nthreads number of workers (0 = all CPUs)
+ * @param result
+ * @param file_size size of the file
+ * @return int 0 on success, -1 on error (errno is set)
+ **/
+int checksum_file(
+    const char* path, checksum_algo_t algo, unsigned nthreads, checksum_result_t* result, size_t* file_size);
+
+#endif    // CHECKSUM_H
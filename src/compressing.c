@@ -1,6 +1,21 @@
+#include "compressing.h"
+
+#include <errno.h>
+#include <immintrin.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#include "algos.h"
+#include "fib_algos.h"
+
+// LEB128 needs at most 10 bytes for a 64-bit value
+#define RLE_VARINT_MAX 10
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
 
 void rle_encode(const char* input, char* output) {
     int input_len = strlen(input);
@@ -35,39 +50,1686 @@ void rle_encode(const char* input, char* output) {
     output[output_index] = '\0';
 }
 
+// counts saturate instead of wrapping, the caller's capacity check rejects such input
+static size_t rle_parse_count(const char* input, size_t* pos) {
+    size_t count = 0;
+    while (input[*pos] >= '0' && input[*pos] <= '9') {
+        size_t digit = (size_t)(input[*pos] - '0');
+        count = count > (SIZE_MAX - digit) / 10 ? SIZE_MAX : count * 10 + digit;
+        (*pos)++;
+    }
+    return count;
+}
+
+size_t rle_decoded_len(const char* input) {
+    size_t total = 0;
+    size_t i = 0;
+
+    while (input[i]) {
+        size_t count = 1;
+        if (input[i] >= '0' && input[i] <= '9') {
+            count = rle_parse_count(input, &i);
+            if (!input[i]) {
+                break;
+            }
+        }
+        total = count > SIZE_MAX - total ? SIZE_MAX : total + count;
+        i++;
+    }
+    return total;
+}
+
+int rle_decode_into(const char* input, char* output, size_t capacity, size_t* written) {
+    size_t out = 0;
+    size_t i = 0;
+
+    *written = 0;
+    if (capacity == 0) {
+        errno = ENOSPC;
+        return -1;
+    }
+    while (input[i]) {
+        size_t count = 1;
+        if (input[i] >= '0' && input[i] <= '9') {
+            count = rle_parse_count(input, &i);
+            // digits without a symbol at the end carry no data
+            if (!input[i]) {
+                break;
+            }
+        }
+        if (capacity - out <= count) {
+            errno = ENOSPC;
+            return -1;
+        }
+        memset(output + out, input[i++], count);
+        out += count;
+    }
+
+    output[out] = '\0';
+    *written = out;
+    return 0;
+}
+
 char* rle_decode(const char* input) {
-    int input_len = strlen(input);
-    char* output = malloc((input_len * 10) + 1);
+    size_t len = rle_decoded_len(input);
+    size_t written;
+
+    char* output = len < SIZE_MAX ? malloc(len + 1) : NULL;
     if (!output) {
         return NULL;
     }
+    rle_decode_into(input, output, len + 1, &written);
+    return output;
+}
 
-    int output_index = 0;
-    int i = 0;
+static size_t rle_varint_len(uint64_t value) {
+    size_t n = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        n++;
+    }
+    return n;
+}
 
-    while (i < input_len) {
-        if (input[i] >= '0' && input[i] <= '9') {
-            int count = 0;
-            while (i < input_len && input[i] >= '0' && input[i] <= '9') {
-                count = count * 10 + (input[i] - '0');
-                i++;
+static size_t rle_put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static int rle_get_varint(const uint8_t* in, size_t len, size_t* pos, uint64_t* value) {
+    uint64_t result = 0;
+
+    for (unsigned shift = 0; shift < 7 * RLE_VARINT_MAX && *pos < len; shift += 7) {
+        uint8_t byte = in[(*pos)++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+typedef size_t (*rle_scan_fn)(const uint8_t* input, size_t pos, size_t len);
+
+static size_t rle_run_length(const uint8_t* input, size_t pos, size_t len) {
+    size_t end = pos + 1;
+    while (end < len && input[end] == input[pos]) {
+        end++;
+    }
+    return end - pos;
+}
+
+// first position from pos where RLE_MIN_RUN (3) equal bytes start, len if none
+static size_t rle_find_run(const uint8_t* input, size_t pos, size_t len) {
+    for (size_t i = pos; i + 2 < len; i++) {
+        if (input[i] == input[i + 1] && input[i + 1] == input[i + 2]) {
+            return i;
+        }
+    }
+    return len;
+}
+
+// the vector compared with itself shifted by one and two bytes marks every run start
+AVX2_TARGET static size_t rle_find_run_avx2(const uint8_t* input, size_t pos, size_t len) {
+    size_t i = pos;
+
+    for (; i + 34 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(input + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(input + i + 1));
+        __m256i c = _mm256_loadu_si256((const __m256i*)(input + i + 2));
+        __m256i triple = _mm256_and_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(b, c));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(triple);
+        if (mask) {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return rle_find_run(input, i, len);
+}
+
+AVX2_TARGET static size_t rle_run_length_avx2(const uint8_t* input, size_t pos, size_t len) {
+    const __m256i value = _mm256_set1_epi8((char)input[pos]);
+    size_t i = pos + 1;
+
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(input + i));
+        uint32_t differ = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, value));
+        if (differ) {
+            return i + (size_t)__builtin_ctz(differ) - pos;
+        }
+    }
+    while (i < len && input[i] == input[pos]) {
+        i++;
+    }
+    return i - pos;
+}
+
+AVX512_TARGET static size_t rle_find_run_avx512(const uint8_t* input, size_t pos, size_t len) {
+    size_t i = pos;
+
+    for (; i + 66 <= len; i += 64) {
+        __m512i a = _mm512_loadu_si512((const void*)(input + i));
+        __m512i b = _mm512_loadu_si512((const void*)(input + i + 1));
+        __m512i c = _mm512_loadu_si512((const void*)(input + i + 2));
+        uint64_t mask = _mm512_cmpeq_epi8_mask(a, b) & _mm512_cmpeq_epi8_mask(b, c);
+        if (mask) {
+            return i + (size_t)__builtin_ctzll(mask);
+        }
+    }
+    return rle_find_run(input, i, len);
+}
+
+AVX512_TARGET static size_t rle_run_length_avx512(const uint8_t* input, size_t pos, size_t len) {
+    const __m512i value = _mm512_set1_epi8((char)input[pos]);
+    size_t i = pos + 1;
+
+    for (; i + 64 <= len; i += 64) {
+        uint64_t differ = ~_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)(input + i)), value);
+        if (differ) {
+            return i + (size_t)__builtin_ctzll(differ) - pos;
+        }
+    }
+    while (i < len && input[i] == input[pos]) {
+        i++;
+    }
+    return i - pos;
+}
+
+// literal segments cost their varint, runs of RLE_MIN_RUN or more save at least one byte
+size_t rle_bound(size_t len) {
+    return len + len / 64 + RLE_VARINT_MAX;
+}
+
+static int rle_put_literal(const uint8_t* literal, size_t n, uint8_t* output, size_t capacity, size_t* out) {
+    uint64_t token = ((uint64_t)n << 1) | 1;
+
+    if (capacity - *out < rle_varint_len(token) + n) {
+        return -1;
+    }
+    *out += rle_put_varint(output + *out, token);
+    memcpy(output + *out, literal, n);
+    *out += n;
+    return 0;
+}
+
+// jumps from run to run, the bytes in between are copied as one literal segment
+static int rle_encode_with(
+    const uint8_t* input,
+    size_t len,
+    uint8_t* output,
+    size_t capacity,
+    size_t* written,
+    rle_scan_fn find_run,
+    rle_scan_fn run_length) {
+    size_t out = 0;
+    size_t pos = 0;
+
+    *written = 0;
+    while (pos < len) {
+        size_t start = find_run(input, pos, len);
+        if (start == len) {
+            break;
+        }
+
+        size_t run = run_length(input, start, len);
+        uint64_t token = (uint64_t)run << 1;
+        if ((start > pos && rle_put_literal(input + pos, start - pos, output, capacity, &out) < 0)
+            || capacity - out < rle_varint_len(token) + 1) {
+            errno = ENOSPC;
+            return -1;
+        }
+        out += rle_put_varint(output + out, token);
+        output[out++] = input[start];
+        pos = start + run;
+    }
+
+    if (len > pos && rle_put_literal(input + pos, len - pos, output, capacity, &out) < 0) {
+        errno = ENOSPC;
+        return -1;
+    }
+    *written = out;
+    return 0;
+}
+
+int rle_encode_bytes_scalar(
+    const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    return rle_encode_with(input, len, output, capacity, written, rle_find_run, rle_run_length);
+}
+
+static void rle_select_scans(rle_scan_fn* find_run, rle_scan_fn* run_length) {
+    if (__builtin_cpu_supports("avx512bw")) {
+        *find_run = rle_find_run_avx512;
+        *run_length = rle_run_length_avx512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        *find_run = rle_find_run_avx2;
+        *run_length = rle_run_length_avx2;
+    } else {
+        *find_run = rle_find_run;
+        *run_length = rle_run_length;
+    }
+}
+
+int rle_encode_bytes(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    rle_scan_fn find_run;
+    rle_scan_fn run_length;
+
+    rle_select_scans(&find_run, &run_length);
+    return rle_encode_with(input, len, output, capacity, written, find_run, run_length);
+}
+
+int rle_decode_bytes(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    size_t pos = 0;
+    size_t out = 0;
+
+    *written = 0;
+    while (pos < len) {
+        uint64_t token;
+        if (rle_get_varint(input, len, &pos, &token) < 0 || token >> 1 == 0) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        uint64_t n = token >> 1;
+        if (token & 1) {
+            if (len - pos < n) {
+                errno = EINVAL;
+                return -1;
+            }
+            if (capacity - out < n) {
+                errno = ENOSPC;
+                return -1;
+            }
+            memcpy(output + out, input + pos, n);
+            pos += n;
+        } else {
+            if (pos == len) {
+                errno = EINVAL;
+                return -1;
+            }
+            if (capacity - out < n) {
+                errno = ENOSPC;
+                return -1;
             }
+            memset(output + out, input[pos++], n);
+        }
+        out += n;
+    }
 
-            if (i < input_len) {
-                char symbol = input[i];
-                for (int j = 0; j < count && output_index < input_len * 10; j++) {
-                    output[output_index++] = symbol;
-                }
-                i++;
+    *written = out;
+    return 0;
+}
+
+void rle_window_init(rle_window_t* window, const uint8_t* input, size_t len) {
+    memset(window, 0, sizeof(*window));
+    window->input = input;
+    window->len = len;
+}
+
+int rle_window_decode(rle_window_t* window, uint8_t* output, size_t capacity, size_t* written) {
+    size_t out = 0;
+
+    while (out < capacity) {
+        if (window->pending == 0) {
+            uint64_t token;
+
+            if (window->pos == window->len) {
+                break;
             }
+            if (rle_get_varint(window->input, window->len, &window->pos, &token) < 0 || token >> 1 == 0
+                || (!(token & 1) && window->pos == window->len)) {
+                errno = EINVAL;
+                return -1;
+            }
+            window->pending = token >> 1;
+            window->literal = (int)(token & 1);
+            if (!window->literal) {
+                window->value = window->input[window->pos++];
+            }
+        }
+
+        size_t n = capacity - out < window->pending ? capacity - out : (size_t)window->pending;
+        if (window->literal) {
+            if (window->len - window->pos < n) {
+                errno = EINVAL;
+                return -1;
+            }
+            memcpy(output + out, window->input + window->pos, n);
+            window->pos += n;
         } else {
-            if (output_index < input_len * 10) {
-                output[output_index++] = input[i++];
+            memset(output + out, window->value, n);
+        }
+        window->pending -= n;
+        out += n;
+    }
+
+    *written = out;
+    return 0;
+}
+
+int rle_decoded_size(const uint8_t* input, size_t len, size_t* size) {
+    size_t pos = 0;
+    uint64_t total = 0;
+
+    *size = 0;
+    while (pos < len) {
+        uint64_t token;
+        if (rle_get_varint(input, len, &pos, &token) < 0 || token >> 1 == 0) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        uint64_t n = token >> 1;
+        uint64_t skip = token & 1 ? n : 1;
+        if (len - pos < skip || n > SIZE_MAX - total) {
+            errno = EINVAL;
+            return -1;
+        }
+        pos += skip;
+        total += n;
+    }
+
+    *size = (size_t)total;
+    return 0;
+}
+
+// copy into the output buffer, handing full buffers to the sink
+static int rle_stream_put(
+    rle_sink_fn sink, void* ctx, uint8_t* out, size_t* out_len, size_t size, const uint8_t* data, size_t n) {
+    while (n > 0) {
+        if (*out_len == size) {
+            if (sink(ctx, out, size) < 0) {
+                return -1;
+            }
+            *out_len = 0;
+        }
+        size_t take = size - *out_len < n ? size - *out_len : n;
+        memcpy(out + *out_len, data, take);
+        *out_len += take;
+        data += take;
+        n -= take;
+    }
+    return 0;
+}
+
+static int rle_stream_flush(rle_sink_fn sink, void* ctx, uint8_t* out, size_t* out_len) {
+    if (*out_len > 0 && sink(ctx, out, *out_len) < 0) {
+        return -1;
+    }
+    *out_len = 0;
+    return 0;
+}
+
+static int rle_encoder_put(rle_encoder_t* enc, const uint8_t* data, size_t n) {
+    return rle_stream_put(enc->sink, enc->ctx, enc->out, &enc->out_len, enc->buffer_size, data, n);
+}
+
+static int rle_encoder_put_token(rle_encoder_t* enc, uint64_t token) {
+    uint8_t varint[RLE_VARINT_MAX];
+    return rle_encoder_put(enc, varint, rle_put_varint(varint, token));
+}
+
+static int rle_encoder_flush_literal(rle_encoder_t* enc) {
+    if (enc->literal_len == 0) {
+        return 0;
+    }
+    if (rle_encoder_put_token(enc, ((uint64_t)enc->literal_len << 1) | 1) < 0
+        || rle_encoder_put(enc, enc->literal, enc->literal_len) < 0) {
+        return -1;
+    }
+    enc->literal_len = 0;
+    return 0;
+}
+
+// literal bytes are staged so that segments spanning chunks stay one segment up to buffer_size
+static int rle_encoder_add_literal(rle_encoder_t* enc, const uint8_t* data, size_t n) {
+    while (n > 0) {
+        if (enc->literal_len == enc->buffer_size && rle_encoder_flush_literal(enc) < 0) {
+            return -1;
+        }
+        size_t take = enc->buffer_size - enc->literal_len < n ? enc->buffer_size - enc->literal_len : n;
+        memcpy(enc->literal + enc->literal_len, data, take);
+        enc->literal_len += take;
+        data += take;
+        n -= take;
+    }
+    return 0;
+}
+
+// the carried run is finished: long runs become a run segment, short ones join the literal
+static int rle_encoder_close_run(rle_encoder_t* enc) {
+    uint64_t run = enc->run_len;
+
+    enc->run_len = 0;
+    if (run >= RLE_MIN_RUN) {
+        if (rle_encoder_flush_literal(enc) < 0 || rle_encoder_put_token(enc, run << 1) < 0) {
+            return -1;
+        }
+        return rle_encoder_put(enc, &enc->run_value, 1);
+    }
+
+    uint8_t bytes[RLE_MIN_RUN];
+    memset(bytes, enc->run_value, sizeof(bytes));
+    return rle_encoder_add_literal(enc, bytes, (size_t)run);
+}
+
+int rle_encoder_init(rle_encoder_t* enc, size_t buffer_size, rle_sink_fn sink, void* ctx) {
+    memset(enc, 0, sizeof(*enc));
+    if (buffer_size < RLE_VARINT_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    enc->out = malloc(buffer_size);
+    enc->literal = malloc(buffer_size);
+    if (!enc->out || !enc->literal) {
+        rle_encoder_free(enc);
+        errno = ENOMEM;
+        return -1;
+    }
+    enc->buffer_size = buffer_size;
+    enc->sink = sink;
+    enc->ctx = ctx;
+    return 0;
+}
+
+void rle_encoder_free(rle_encoder_t* enc) {
+    free(enc->out);
+    free(enc->literal);
+    memset(enc, 0, sizeof(*enc));
+}
+
+int rle_encoder_write(rle_encoder_t* enc, const uint8_t* data, size_t len) {
+    rle_scan_fn find_run;
+    rle_scan_fn run_length;
+    size_t pos = 0;
+
+    rle_select_scans(&find_run, &run_length);
+
+    // a run left open by the previous chunk continues while the bytes match
+    if (enc->run_len > 0) {
+        while (pos < len && data[pos] == enc->run_value) {
+            pos++;
+        }
+        enc->run_len += pos;
+        if (pos == len) {
+            return 0;
+        }
+        if (rle_encoder_close_run(enc) < 0) {
+            return -1;
+        }
+    }
+
+    while (pos < len) {
+        size_t start = find_run(data, pos, len);
+
+        // no run left in the chunk: the last one or two equal bytes may start one in the next
+        if (start == len) {
+            size_t tail = 1;
+            while (tail < 2 && len - tail > pos && data[len - tail - 1] == data[len - 1]) {
+                tail++;
+            }
+            if (rle_encoder_add_literal(enc, data + pos, len - tail - pos) < 0) {
+                return -1;
+            }
+            enc->run_value = data[len - 1];
+            enc->run_len = tail;
+            return 0;
+        }
+
+        size_t run = run_length(data, start, len);
+        if (rle_encoder_add_literal(enc, data + pos, start - pos) < 0) {
+            return -1;
+        }
+        enc->run_value = data[start];
+        enc->run_len = run;
+        pos = start + run;
+        if (pos == len) {
+            return 0;
+        }
+        if (rle_encoder_close_run(enc) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int rle_encoder_finish(rle_encoder_t* enc) {
+    if (rle_encoder_close_run(enc) < 0 || rle_encoder_flush_literal(enc) < 0) {
+        return -1;
+    }
+    return rle_stream_flush(enc->sink, enc->ctx, enc->out, &enc->out_len);
+}
+
+int rle_decoder_init(rle_decoder_t* dec, size_t buffer_size, rle_sink_fn sink, void* ctx) {
+    memset(dec, 0, sizeof(*dec));
+    if (buffer_size == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    dec->out = malloc(buffer_size);
+    if (!dec->out) {
+        errno = ENOMEM;
+        return -1;
+    }
+    dec->buffer_size = buffer_size;
+    dec->sink = sink;
+    dec->ctx = ctx;
+    return 0;
+}
+
+void rle_decoder_free(rle_decoder_t* dec) {
+    free(dec->out);
+    memset(dec, 0, sizeof(*dec));
+}
+
+// run bytes go straight into the output buffer with memset, one buffer at a time
+static int rle_decoder_emit_run(rle_decoder_t* dec) {
+    while (dec->pending > 0) {
+        if (dec->out_len == dec->buffer_size) {
+            if (dec->sink(dec->ctx, dec->out, dec->buffer_size) < 0) {
+                return -1;
+            }
+            dec->out_len = 0;
+        }
+        size_t room = dec->buffer_size - dec->out_len;
+        size_t take = dec->pending < room ? (size_t)dec->pending : room;
+        memset(dec->out + dec->out_len, dec->value, take);
+        dec->out_len += take;
+        dec->pending -= take;
+    }
+    return 0;
+}
+
+int rle_decoder_write(rle_decoder_t* dec, const uint8_t* data, size_t len) {
+    size_t pos = 0;
+
+    while (pos < len) {
+        if (dec->literal && dec->pending > 0) {
+            size_t take = len - pos < dec->pending ? len - pos : (size_t)dec->pending;
+            size_t size = dec->buffer_size;
+            if (rle_stream_put(dec->sink, dec->ctx, dec->out, &dec->out_len, size, data + pos, take) < 0) {
+                return -1;
+            }
+            dec->pending -= take;
+            pos += take;
+            continue;
+        }
+        if (dec->need_value) {
+            dec->value = data[pos++];
+            dec->need_value = 0;
+            if (rle_decoder_emit_run(dec) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        // segment header, its varint may be split across writes
+        uint8_t byte = data[pos++];
+        if (dec->shift >= 7 * RLE_VARINT_MAX) {
+            errno = EINVAL;
+            return -1;
+        }
+        dec->token |= (uint64_t)(byte & 0x7f) << dec->shift;
+        dec->shift += 7;
+        if (byte & 0x80) {
+            continue;
+        }
+        if (dec->token >> 1 == 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        dec->pending = dec->token >> 1;
+        dec->literal = (int)(dec->token & 1);
+        dec->need_value = !dec->literal;
+        dec->token = 0;
+        dec->shift = 0;
+    }
+    return 0;
+}
+
+int rle_decoder_finish(rle_decoder_t* dec) {
+    if (dec->shift != 0 || dec->pending != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return rle_stream_flush(dec->sink, dec->ctx, dec->out, &dec->out_len);
+}
+
+static int rle_fd_sink(void* ctx, const uint8_t* data, size_t len) {
+    int fd = *(const int*)ctx;
+
+    while (len > 0) {
+        ssize_t w = write(fd, data, len);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+static ssize_t rle_read_full(int fd, uint8_t* buf, size_t cap) {
+    size_t have = 0;
+
+    while (have < cap) {
+        ssize_t r = read(fd, buf + have, cap - have);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (r == 0) {
+            break;
+        }
+        have += (size_t)r;
+    }
+    return (ssize_t)have;
+}
+
+int rle_encode_fd(int in_fd, int out_fd, size_t buffer_size) {
+    rle_encoder_t enc;
+    uint8_t* buf = malloc(buffer_size ? buffer_size : 1);
+
+    if (!buf || rle_encoder_init(&enc, buffer_size, rle_fd_sink, &out_fd) < 0) {
+        int err = buf ? errno : ENOMEM;
+        free(buf);
+        errno = err;
+        return -1;
+    }
+
+    int status = 0;
+    for (;;) {
+        ssize_t n = rle_read_full(in_fd, buf, buffer_size);
+        if (n < 0 || (n > 0 && rle_encoder_write(&enc, buf, (size_t)n) < 0)) {
+            status = -1;
+            break;
+        }
+        if ((size_t)n < buffer_size) {
+            status = rle_encoder_finish(&enc);
+            break;
+        }
+    }
+
+    int err = errno;
+    rle_encoder_free(&enc);
+    free(buf);
+    errno = err;
+    return status;
+}
+
+int rle_decode_fd(int in_fd, int out_fd, size_t buffer_size) {
+    rle_decoder_t dec;
+    uint8_t* buf = malloc(buffer_size ? buffer_size : 1);
+
+    if (!buf || rle_decoder_init(&dec, buffer_size, rle_fd_sink, &out_fd) < 0) {
+        int err = buf ? errno : ENOMEM;
+        free(buf);
+        errno = err;
+        return -1;
+    }
+
+    int status = 0;
+    for (;;) {
+        ssize_t n = rle_read_full(in_fd, buf, buffer_size);
+        if (n < 0 || (n > 0 && rle_decoder_write(&dec, buf, (size_t)n) < 0)) {
+            status = -1;
+            break;
+        }
+        if ((size_t)n < buffer_size) {
+            status = rle_decoder_finish(&dec);
+            break;
+        }
+    }
+
+    int err = errno;
+    rle_decoder_free(&dec);
+    free(buf);
+    errno = err;
+    return status;
+}
+
+// the last match starts at least LZ77_MF_LIMIT bytes before the end and leaves LZ77_LAST_LITERALS
+// literals, so the 8-byte reads of the match finder never leave the input
+#define LZ77_LAST_LITERALS 5
+#define LZ77_MF_LIMIT 12
+// after 2^LZ77_SKIP_TRIGGER misses in a row the encoder advances 2 bytes at a time, then 3, ...
+#define LZ77_SKIP_TRIGGER 6
+
+static inline uint32_t lz77_read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t lz77_read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz77_hash(const uint8_t* p) {
+    return fib_hash32(lz77_read32(p), LZ77_HASH_BITS);
+}
+
+// common prefix of ref and ip, ip stops at limit, compared 8 bytes at a time
+static inline size_t lz77_count(const uint8_t* ref, const uint8_t* ip, const uint8_t* limit) {
+    const uint8_t* start = ip;
+
+    while (limit - ip >= 8) {
+        uint64_t diff = lz77_read64(ref) ^ lz77_read64(ip);
+        if (diff) {
+            return (size_t)(ip - start) + (__builtin_ctzll(diff) >> 3);
+        }
+        ref += 8;
+        ip += 8;
+    }
+    while (ip < limit && *ref == *ip) {
+        ref++;
+        ip++;
+    }
+    return (size_t)(ip - start);
+}
+
+static inline size_t lz77_length_bytes(size_t n) {
+    return n >= 15 ? (n - 15) / 255 + 1 : 0;
+}
+
+static inline uint8_t* lz77_put_length(uint8_t* op, size_t n) {
+    for (n -= 15; n >= 255; n -= 255) {
+        *op++ = 255;
+    }
+    *op++ = (uint8_t)n;
+    return op;
+}
+
+// encoded size of a sequence, match_len 0 is the closing literals-only one
+static inline size_t lz77_sequence_len(size_t nlit, size_t match_len) {
+    size_t extra = match_len ? match_len - LZ77_MIN_MATCH : 0;
+    return 1 + lz77_length_bytes(nlit) + nlit + (match_len ? 2 + lz77_length_bytes(extra) : 0);
+}
+
+// match_len 0 writes the closing literals-only sequence
+static int lz77_put_sequence(
+    uint8_t* output,
+    size_t capacity,
+    size_t* pos,
+    const uint8_t* literals,
+    size_t nlit,
+    size_t offset,
+    size_t match_len) {
+    size_t extra = match_len ? match_len - LZ77_MIN_MATCH : 0;
+    size_t need = lz77_sequence_len(nlit, match_len);
+
+    if (capacity - *pos < need) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    uint8_t* op = output + *pos;
+    uint8_t* token = op++;
+    *token = (uint8_t)((nlit >= 15 ? 15 : nlit) << 4);
+    if (nlit >= 15) {
+        op = lz77_put_length(op, nlit);
+    }
+    memcpy(op, literals, nlit);
+    op += nlit;
+
+    if (match_len) {
+        *op++ = (uint8_t)offset;
+        *op++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)(extra >= 15 ? 15 : extra);
+        if (extra >= 15) {
+            op = lz77_put_length(op, extra);
+        }
+    }
+    *pos = (size_t)(op - output);
+    return 0;
+}
+
+// greedy match finder of lz77_encode, also run by the codec_stats estimate: hashes positions from
+// *ip below end, skipping ahead faster on misses, until a verified match, which is extended back
+// towards anchor. Returns its length with *ip at its start and *ref at its source, 0 past end.
+static size_t lz77_next_match(
+    const uint8_t* input,
+    uint32_t* table,
+    size_t* ip,
+    size_t end,
+    size_t anchor,
+    const uint8_t* match_limit,
+    size_t* ref) {
+    size_t misses = 1u << LZ77_SKIP_TRIGGER;
+    size_t pos = *ip;
+
+    while (pos < end) {
+        uint32_t h = lz77_hash(input + pos);
+        size_t candidate = table[h];
+
+        table[h] = (uint32_t)pos;
+        if (pos - candidate > LZ77_MAX_OFFSET || lz77_read32(input + candidate) != lz77_read32(input + pos)) {
+            pos += misses++ >> LZ77_SKIP_TRIGGER;
+            continue;
+        }
+
+        while (pos > anchor && candidate > 0 && input[pos - 1] == input[candidate - 1]) {
+            pos--;
+            candidate--;
+        }
+        const uint8_t* next = input + pos + LZ77_MIN_MATCH;
+        *ip = pos;
+        *ref = candidate;
+        return LZ77_MIN_MATCH + lz77_count(input + candidate + LZ77_MIN_MATCH, next, match_limit);
+    }
+    *ip = pos;
+    return 0;
+}
+
+// moves past a match and hashes a position near its end, so that the next match can follow on
+static inline size_t lz77_skip_match(
+    const uint8_t* input, uint32_t* table, size_t ip, size_t match_len, size_t mf_limit) {
+    ip += match_len;
+    if (ip <= mf_limit) {
+        table[lz77_hash(input + ip - 2)] = (uint32_t)(ip - 2);
+    }
+    return ip;
+}
+
+size_t lz77_bound(size_t len) {
+    return len + len / 255 + 16;
+}
+
+int lz77_encode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    uint32_t table[1u << LZ77_HASH_BITS];
+    size_t pos = 0;
+    size_t anchor = 0;
+
+    *written = 0;
+    if (len > UINT32_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (len > LZ77_MF_LIMIT) {
+        const uint8_t* match_limit = input + len - LZ77_LAST_LITERALS;
+        size_t mf_limit = len - LZ77_MF_LIMIT;
+        size_t ip = 1;
+        size_t ref;
+
+        // empty slots point at position 0, candidates are verified anyway
+        memset(table, 0, sizeof(table));
+        for (;;) {
+            size_t match_len = lz77_next_match(input, table, &ip, mf_limit + 1, anchor, match_limit, &ref);
+            if (match_len == 0) {
+                break;
+            }
+            size_t nlit = ip - anchor;
+            if (lz77_put_sequence(output, capacity, &pos, input + anchor, nlit, ip - ref, match_len) < 0) {
+                return -1;
+            }
+            ip = lz77_skip_match(input, table, ip, match_len, mf_limit);
+            anchor = ip;
+        }
+    }
+
+    if (lz77_put_sequence(output, capacity, &pos, input + anchor, len - anchor, 0, 0) < 0) {
+        return -1;
+    }
+    *written = pos;
+    return 0;
+}
+
+static int lz77_get_length(const uint8_t* input, size_t len, size_t* pos, size_t* n) {
+    uint8_t b;
+
+    do {
+        if (*pos == len || *n > SIZE_MAX - 255) {
+            return -1;
+        }
+        b = input[(*pos)++];
+        *n += b;
+    } while (b == 255);
+    return 0;
+}
+
+int lz77_decode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    size_t ip = 0;
+    size_t op = 0;
+
+    *written = 0;
+    while (ip < len) {
+        unsigned token = input[ip++];
+        size_t nlit = token >> 4;
+
+        if (nlit == 15 && lz77_get_length(input, len, &ip, &nlit) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (len - ip < nlit) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (capacity - op < nlit) {
+            errno = ENOSPC;
+            return -1;
+        }
+        // short literal runs are copied as one 16-byte block when both buffers have room
+        if (nlit <= 16 && len - ip >= 16 && capacity - op >= 16) {
+            memcpy(output + op, input + ip, 16);
+        } else {
+            memcpy(output + op, input + ip, nlit);
+        }
+        ip += nlit;
+        op += nlit;
+        if (ip == len) {
+            break;
+        }
+
+        if (len - ip < 2) {
+            errno = EINVAL;
+            return -1;
+        }
+        size_t offset = input[ip] | (size_t)input[ip + 1] << 8;
+        size_t match_len = token & 15;
+        ip += 2;
+        if (offset == 0 || offset > op
+            || (match_len == 15 && lz77_get_length(input, len, &ip, &match_len) < 0)) {
+            errno = EINVAL;
+            return -1;
+        }
+        match_len += LZ77_MIN_MATCH;
+        if (capacity - op < match_len) {
+            errno = ENOSPC;
+            return -1;
+        }
+
+        uint8_t* dst = output + op;
+        if (offset == 1) {
+            memset(dst, dst[-1], match_len);
+        } else {
+            // copy from a multiple of the offset that is at least 8 back, the pattern repeats there
+            size_t dist = offset;
+            size_t i = 0;
+            while (dist < 8) {
+                dist += offset;
+            }
+            for (; i < dist - offset && i < match_len; i++) {
+                dst[i] = dst[i - offset];
+            }
+            if (capacity - op - match_len >= 8) {
+                for (; i < match_len; i += 8) {
+                    memcpy(dst + i, dst + i - dist, 8);
+                }
             } else {
+                for (; i < match_len; i++) {
+                    dst[i] = dst[i - offset];
+                }
+            }
+        }
+        op += match_len;
+    }
+
+    *written = op;
+    return 0;
+}
+
+#define HUFFMAN_STORED 0
+#define HUFFMAN_RUN 1
+#define HUFFMAN_CODED 2
+#define HUFFMAN_TABLE_SIZE (1u << HUFFMAN_MAX_BITS)
+// symbols decoded per stream between two refills, 5 * HUFFMAN_MAX_BITS fits in the 56 refilled bits
+#define HUFFMAN_BURST 5
+
+typedef struct {
+    uint64_t count;
+    uint32_t symbol;
+} huffman_leaf_t;
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint64_t bits;
+    unsigned count;
+} huffman_reader_t;
+
+static int huffman_compare_leaf(const void* a, const void* b) {
+    const huffman_leaf_t* x = a;
+    const huffman_leaf_t* y = b;
+    if (x->count != y->count) {
+        return (x->count > y->count) - (x->count < y->count);
+    }
+    return (x->symbol > y->symbol) - (x->symbol < y->symbol);
+}
+
+// two-queue construction: leaves sorted by count, internal nodes are created in weight order
+static unsigned huffman_tree_lengths(huffman_leaf_t* leaves, size_t n, uint8_t* lengths) {
+    uint64_t weight[256];
+    uint16_t leaf_parent[256];
+    uint16_t node_parent[256];
+    uint8_t depth[256];
+    size_t leaf = 0;
+    size_t node = 0;
+    unsigned max_len = 0;
+
+    if (n < 2) {
+        lengths[leaves[0].symbol] = 1;
+        return 1;
+    }
+
+    qsort(leaves, n, sizeof(huffman_leaf_t), huffman_compare_leaf);
+    for (size_t k = 0; k + 1 < n; k++) {
+        weight[k] = 0;
+        for (int pick = 0; pick < 2; pick++) {
+            if (leaf < n && (node == k || leaves[leaf].count <= weight[node])) {
+                weight[k] += leaves[leaf].count;
+                leaf_parent[leaf++] = (uint16_t)k;
+            } else {
+                weight[k] += weight[node];
+                node_parent[node++] = (uint16_t)k;
+            }
+        }
+    }
+
+    depth[n - 2] = 0;
+    for (size_t k = n - 2; k-- > 0;) {
+        depth[k] = depth[node_parent[k]] + 1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        unsigned len = depth[leaf_parent[i]] + 1u;
+        lengths[leaves[i].symbol] = (uint8_t)(len < 255 ? len : 255);
+        max_len = len > max_len ? len : max_len;
+    }
+    return max_len;
+}
+
+// too deep trees are rebuilt from halved counts until they fit, all counts at 1 give 8 bits
+static void huffman_limited_lengths(const uint64_t* counts, uint8_t* lengths) {
+    huffman_leaf_t leaves[256];
+    uint64_t scaled[256];
+    size_t n = 0;
+
+    memcpy(scaled, counts, sizeof(scaled));
+    memset(lengths, 0, 256);
+    for (;;) {
+        n = 0;
+        for (unsigned s = 0; s < 256; s++) {
+            if (scaled[s]) {
+                leaves[n].count = scaled[s];
+                leaves[n].symbol = s;
+                n++;
+            }
+        }
+        if (huffman_tree_lengths(leaves, n, lengths) <= HUFFMAN_MAX_BITS) {
+            return;
+        }
+        for (unsigned s = 0; s < 256; s++) {
+            scaled[s] = scaled[s] ? (scaled[s] >> 1) | 1 : 0;
+        }
+    }
+}
+
+// canonical codes in symbol order within each length, bit-reversed for the LSB-first bitstream
+static void huffman_codes(const uint8_t* lengths, uint16_t* codes) {
+    unsigned bl_count[HUFFMAN_MAX_BITS + 1] = {0};
+    unsigned next[HUFFMAN_MAX_BITS + 1];
+    unsigned code = 0;
+
+    for (unsigned s = 0; s < 256; s++) {
+        bl_count[lengths[s]]++;
+    }
+    bl_count[0] = 0;
+    for (unsigned bits = 1; bits <= HUFFMAN_MAX_BITS; bits++) {
+        code = (code + bl_count[bits - 1]) << 1;
+        next[bits] = code;
+    }
+
+    for (unsigned s = 0; s < 256; s++) {
+        unsigned len = lengths[s];
+        unsigned c = len ? next[len]++ : 0;
+        unsigned reversed = 0;
+        for (unsigned b = 0; b < len; b++) {
+            reversed |= ((c >> b) & 1) << (len - 1 - b);
+        }
+        codes[s] = (uint16_t)reversed;
+    }
+}
+
+// entry = symbol | length << 8, only complete codes (Kraft sum exactly 1) are accepted
+static int huffman_build_table(const uint8_t* lengths, uint16_t* table) {
+    uint16_t codes[256];
+    size_t kraft = 0;
+
+    for (unsigned s = 0; s < 256; s++) {
+        if (lengths[s] > HUFFMAN_MAX_BITS) {
+            return -1;
+        }
+        if (lengths[s]) {
+            kraft += HUFFMAN_TABLE_SIZE >> lengths[s];
+        }
+    }
+    if (kraft != HUFFMAN_TABLE_SIZE) {
+        return -1;
+    }
+
+    huffman_codes(lengths, codes);
+    for (unsigned s = 0; s < 256; s++) {
+        unsigned len = lengths[s];
+        if (!len) {
+            continue;
+        }
+        for (unsigned j = codes[s]; j < HUFFMAN_TABLE_SIZE; j += 1u << len) {
+            table[j] = (uint16_t)(s | len << 8);
+        }
+    }
+    return 0;
+}
+
+static uint8_t* huffman_write_stream(
+    uint8_t* op, const uint8_t* input, size_t n, const uint8_t* lengths, const uint16_t* codes) {
+    uint64_t bits = 0;
+    unsigned count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        bits |= (uint64_t)codes[input[i]] << count;
+        count += lengths[input[i]];
+        if (count >= 32) {
+            uint32_t word = (uint32_t)bits;
+            memcpy(op, &word, sizeof(word));
+            op += 4;
+            bits >>= 32;
+            count -= 32;
+        }
+    }
+    for (; count > 0; count = count > 8 ? count - 8 : 0) {
+        *op++ = (uint8_t)bits;
+        bits >>= 8;
+    }
+    return op;
+}
+
+// splits the input into huffman_encode's stream segments and takes their byte histograms, the block
+// histogram is their sum
+static void huffman_segment_histograms(
+    const uint8_t* input,
+    size_t len,
+    size_t begin[HUFFMAN_STREAMS + 1],
+    size_t counts[HUFFMAN_STREAMS][256],
+    uint64_t total[256]) {
+    size_t segment = (len + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+
+    for (int s = 0; s <= HUFFMAN_STREAMS; s++) {
+        begin[s] = (size_t)s * segment < len ? (size_t)s * segment : len;
+    }
+    memset(total, 0, 256 * sizeof(uint64_t));
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        byte_histogram(input + begin[s], begin[s + 1] - begin[s], counts[s]);
+        for (unsigned c = 0; c < 256; c++) {
+            total[c] += counts[s][c];
+        }
+    }
+}
+
+// code lengths from the block histogram and the size of a coded block with header_len header bytes:
+// length table, stream sizes of all but the last stream and the streams, each rounded up to bytes
+static size_t huffman_coded_len(
+    size_t counts[HUFFMAN_STREAMS][256],
+    const uint64_t total[256],
+    size_t header_len,
+    uint8_t lengths[256],
+    size_t stream_bytes[HUFFMAN_STREAMS]) {
+    uint8_t varint[RLE_VARINT_MAX];
+    size_t coded_len = header_len + 128;
+
+    huffman_limited_lengths(total, lengths);
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        uint64_t bits = 0;
+        for (unsigned c = 0; c < 256; c++) {
+            bits += (uint64_t)counts[s][c] * lengths[c];
+        }
+        stream_bytes[s] = (bits + 7) / 8;
+        coded_len += stream_bytes[s];
+        if (s + 1 < HUFFMAN_STREAMS) {
+            coded_len += rle_put_varint(varint, stream_bytes[s]);
+        }
+    }
+    return coded_len;
+}
+
+size_t huffman_bound(size_t len) {
+    return len + 1 + RLE_VARINT_MAX;
+}
+
+int huffman_encode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    size_t counts[HUFFMAN_STREAMS][256];
+    size_t begin[HUFFMAN_STREAMS + 1];
+    size_t stream_bytes[HUFFMAN_STREAMS];
+    uint64_t total[256];
+    uint8_t lengths[256];
+    uint16_t codes[256];
+    uint8_t header[1 + RLE_VARINT_MAX];
+    size_t used = 0;
+    unsigned last = 0;
+
+    *written = 0;
+    huffman_segment_histograms(input, len, begin, counts, total);
+    for (unsigned c = 0; c < 256; c++) {
+        if (total[c]) {
+            used++;
+            last = c;
+        }
+    }
+
+    size_t header_len = 1 + rle_put_varint(header + 1, len);
+    if (used == 1) {
+        header[0] = HUFFMAN_RUN;
+        if (capacity < header_len + 1) {
+            errno = ENOSPC;
+            return -1;
+        }
+        memcpy(output, header, header_len);
+        output[header_len] = (uint8_t)last;
+        *written = header_len + 1;
+        return 0;
+    }
+
+    size_t coded_len = SIZE_MAX;
+    if (used > 1) {
+        coded_len = huffman_coded_len(counts, total, header_len, lengths, stream_bytes);
+    }
+
+    if (coded_len >= header_len + len) {
+        header[0] = HUFFMAN_STORED;
+        if (capacity < header_len + len) {
+            errno = ENOSPC;
+            return -1;
+        }
+        memcpy(output, header, header_len);
+        memcpy(output + header_len, input, len);
+        *written = header_len + len;
+        return 0;
+    }
+    if (capacity < coded_len) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    header[0] = HUFFMAN_CODED;
+    memcpy(output, header, header_len);
+
+    uint8_t* op = output + header_len;
+    for (unsigned c = 0; c < 256; c += 2) {
+        *op++ = (uint8_t)(lengths[c] | lengths[c + 1] << 4);
+    }
+    for (int s = 0; s + 1 < HUFFMAN_STREAMS; s++) {
+        op += rle_put_varint(op, stream_bytes[s]);
+    }
+
+    huffman_codes(lengths, codes);
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        op = huffman_write_stream(op, input + begin[s], begin[s + 1] - begin[s], lengths, codes);
+    }
+    *written = (size_t)(op - output);
+    return 0;
+}
+
+static int huffman_read_header(
+    const uint8_t* input, size_t len, size_t* pos, unsigned* mode, uint64_t* size) {
+    if (len == 0 || input[0] > HUFFMAN_CODED) {
+        return -1;
+    }
+    *mode = input[0];
+    *pos = 1;
+    return rle_get_varint(input, len, pos, size);
+}
+
+int huffman_decoded_size(const uint8_t* input, size_t len, size_t* size) {
+    size_t pos;
+    unsigned mode;
+    uint64_t value;
+
+    if (huffman_read_header(input, len, &pos, &mode, &value) < 0 || value > SIZE_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    *size = (size_t)value;
+    return 0;
+}
+
+// refill to at least 56 bits with one unaligned load, needs 8 readable bytes
+static inline void huffman_refill(huffman_reader_t* r) {
+    r->bits |= lz77_read64(r->p) << r->count;
+    r->p += (63 - r->count) >> 3;
+    r->count |= 56;
+}
+
+static inline uint8_t huffman_next(huffman_reader_t* r, const uint16_t* table) {
+    uint16_t entry = table[r->bits & (HUFFMAN_TABLE_SIZE - 1)];
+    r->bits >>= entry >> 8;
+    r->count -= entry >> 8;
+    return (uint8_t)entry;
+}
+
+// byte-wise refill near the end of a stream, running out of bits mid-code means truncated input
+static int huffman_decode_tail(huffman_reader_t* r, const uint16_t* table, uint8_t* op, uint8_t* end) {
+    while (op < end) {
+        while (r->count <= 56 && r->p < r->end) {
+            r->bits |= (uint64_t)*r->p++ << r->count;
+            r->count += 8;
+        }
+        if ((table[r->bits & (HUFFMAN_TABLE_SIZE - 1)] >> 8) > r->count) {
+            return -1;
+        }
+        *op++ = huffman_next(r, table);
+    }
+    // the stream must end in the byte holding its last code
+    return r->p == r->end && r->count < 8 ? 0 : -1;
+}
+
+int huffman_decode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    uint16_t table[HUFFMAN_TABLE_SIZE];
+    uint8_t lengths[256];
+    huffman_reader_t r[HUFFMAN_STREAMS];
+    uint8_t* op[HUFFMAN_STREAMS];
+    uint8_t* end[HUFFMAN_STREAMS];
+    size_t pos;
+    unsigned mode;
+    uint64_t size;
+
+    *written = 0;
+    if (huffman_read_header(input, len, &pos, &mode, &size) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (size > capacity) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    if (mode == HUFFMAN_STORED || mode == HUFFMAN_RUN) {
+        if (len - pos != (mode == HUFFMAN_STORED ? size : 1)) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (mode == HUFFMAN_STORED) {
+            memcpy(output, input + pos, size);
+        } else {
+            memset(output, input[pos], size);
+        }
+        *written = size;
+        return 0;
+    }
+
+    if (len - pos < 128) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (unsigned c = 0; c < 256; c += 2) {
+        lengths[c] = input[pos] & 15;
+        lengths[c + 1] = input[pos++] >> 4;
+    }
+    if (huffman_build_table(lengths, table) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t segment = (size + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+    size_t stream_start = 0;
+    uint64_t stream_len[HUFFMAN_STREAMS];
+    for (int s = 0; s + 1 < HUFFMAN_STREAMS; s++) {
+        if (rle_get_varint(input, len, &pos, &stream_len[s]) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        size_t left = len - pos - stream_start;
+        if (s + 1 == HUFFMAN_STREAMS) {
+            stream_len[s] = left;
+        }
+        if (stream_len[s] > left) {
+            errno = EINVAL;
+            return -1;
+        }
+        r[s].p = input + pos + stream_start;
+        r[s].end = r[s].p + stream_len[s];
+        r[s].bits = 0;
+        r[s].count = 0;
+        stream_start += stream_len[s];
+
+        size_t first = (size_t)s * segment < size ? (size_t)s * segment : size;
+        op[s] = output + first;
+        end[s] = output + (first + segment < size ? first + segment : size);
+    }
+
+    // one symbol from each stream in turn (unrolled for 4 streams), the last segment is the shortest
+    size_t steps = (size_t)(end[HUFFMAN_STREAMS - 1] - op[HUFFMAN_STREAMS - 1]) / HUFFMAN_BURST;
+    for (; steps > 0; steps--) {
+        if (r[0].end - r[0].p < 8 || r[1].end - r[1].p < 8 || r[2].end - r[2].p < 8
+            || r[3].end - r[3].p < 8) {
+            break;
+        }
+        huffman_refill(&r[0]);
+        huffman_refill(&r[1]);
+        huffman_refill(&r[2]);
+        huffman_refill(&r[3]);
+        for (int k = 0; k < HUFFMAN_BURST; k++) {
+            op[0][k] = huffman_next(&r[0], table);
+            op[1][k] = huffman_next(&r[1], table);
+            op[2][k] = huffman_next(&r[2], table);
+            op[3][k] = huffman_next(&r[3], table);
+        }
+        op[0] += HUFFMAN_BURST;
+        op[1] += HUFFMAN_BURST;
+        op[2] += HUFFMAN_BURST;
+        op[3] += HUFFMAN_BURST;
+    }
+
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        if (huffman_decode_tail(&r[s], table, op[s], end[s]) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    *written = size;
+    return 0;
+}
+
+size_t lz77_huffman_bound(size_t len) {
+    return huffman_bound(lz77_bound(len));
+}
+
+// the intermediate LZ77 stream lives in a temporary buffer
+int lz77_huffman_encode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    size_t lz_len;
+    uint8_t* lz = malloc(lz77_bound(len));
+
+    *written = 0;
+    if (!lz) {
+        errno = ENOMEM;
+        return -1;
+    }
+    int rc = lz77_encode(input, len, lz, lz77_bound(len), &lz_len);
+    if (rc == 0) {
+        rc = huffman_encode(lz, lz_len, output, capacity, written);
+    }
+    int err = errno;
+    free(lz);
+    errno = err;
+    return rc;
+}
+
+int lz77_huffman_decode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written) {
+    size_t lz_len;
+
+    *written = 0;
+    if (huffman_decoded_size(input, len, &lz_len) < 0) {
+        return -1;
+    }
+    // LZ77 output never exceeds its bound, a larger claim cannot decode into capacity
+    if (lz_len > lz77_bound(capacity)) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    uint8_t* lz = malloc(lz_len ? lz_len : 1);
+    if (!lz) {
+        errno = ENOMEM;
+        return -1;
+    }
+    int rc = huffman_decode(input, len, lz, lz_len, &lz_len);
+    if (rc == 0) {
+        rc = lz77_decode(lz, lz_len, output, capacity, written);
+    }
+    int err = errno;
+    free(lz);
+    errno = err;
+    return rc;
+}
+
+static const char* const codec_choice_names[] = {
+    [CODEC_RAW] = "raw",
+    [CODEC_RLE] = "rle",
+    [CODEC_LZ77] = "lz77",
+    [CODEC_HUFFMAN] = "huffman",
+};
+
+// rle_encode_with without the output: same segments, only their sizes are summed
+static size_t rle_encoded_size(const uint8_t* input, size_t len, size_t* runs, size_t* run_bytes) {
+    rle_scan_fn find_run;
+    rle_scan_fn run_length;
+    size_t size = 0;
+    size_t pos = 0;
+
+    rle_select_scans(&find_run, &run_length);
+    *runs = 0;
+    *run_bytes = 0;
+    while (pos < len) {
+        size_t start = find_run(input, pos, len);
+        if (start == len) {
+            break;
+        }
+
+        size_t run = run_length(input, start, len);
+        if (start > pos) {
+            size += rle_varint_len(((uint64_t)(start - pos) << 1) | 1) + (start - pos);
+        }
+        size += rle_varint_len((uint64_t)run << 1) + 1;
+        (*runs)++;
+        *run_bytes += run;
+        pos = start + run;
+    }
+    if (len > pos) {
+        size += rle_varint_len(((uint64_t)(len - pos) << 1) | 1) + (len - pos);
+    }
+    return size;
+}
+
+// huffman_encode without the output
+static size_t huffman_encoded_size(
+    size_t counts[HUFFMAN_STREAMS][256], const uint64_t total[256], size_t len, unsigned distinct) {
+    uint8_t varint[RLE_VARINT_MAX];
+    uint8_t lengths[256];
+    size_t stream_bytes[HUFFMAN_STREAMS];
+    size_t header_len = 1 + rle_put_varint(varint, len);
+
+    if (distinct == 1) {
+        return header_len + 1;
+    }
+    if (distinct == 0) {
+        return header_len;
+    }
+
+    size_t coded_len = huffman_coded_len(counts, total, header_len, lengths, stream_bytes);
+    return coded_len < header_len + len ? coded_len : header_len + len;
+}
+
+// lz77_encode's match finder over sampled windows, matches may reach back into earlier windows;
+// the cost of the parsed bytes is scaled to the whole block
+static size_t lz77_sampled_size(const uint8_t* input, size_t len) {
+    uint32_t table[1u << LZ77_HASH_BITS];
+    size_t sampled = 0;
+    size_t cost = 0;
+
+    if (len <= LZ77_MF_LIMIT) {
+        return lz77_sequence_len(len, 0);
+    }
+
+    const uint8_t* match_limit = input + len - LZ77_LAST_LITERALS;
+    size_t mf_limit = len - LZ77_MF_LIMIT;
+    size_t start = 1;
+
+    memset(table, 0, sizeof(table));
+    while (start <= mf_limit) {
+        size_t end = start + CODEC_SAMPLE_WINDOW <= mf_limit ? start + CODEC_SAMPLE_WINDOW : mf_limit + 1;
+        size_t ip = start;
+        size_t anchor = start;
+        size_t ref;
+
+        for (;;) {
+            size_t match_len = lz77_next_match(input, table, &ip, end, anchor, match_limit, &ref);
+            if (match_len == 0) {
                 break;
             }
+            cost += lz77_sequence_len(ip - anchor, match_len);
+            ip = lz77_skip_match(input, table, ip, match_len, mf_limit);
+            anchor = ip;
         }
+
+        cost += ip - anchor;
+        sampled += ip - start;
+        start = start + CODEC_SAMPLE_STRIDE > ip ? start + CODEC_SAMPLE_STRIDE : ip;
     }
-    output[output_index] = '\0';
-    return output;
+
+    // the closing sequence's token and length bytes, its literals are part of the scaled cost
+    size_t closing = lz77_sequence_len(LZ77_LAST_LITERALS, 0) - LZ77_LAST_LITERALS;
+    return (size_t)((double)cost * len / sampled) + closing;
+}
+
+void codec_stats(const uint8_t* input, size_t len, codec_stats_t* stats) {
+    size_t counts[HUFFMAN_STREAMS][256];
+    size_t begin[HUFFMAN_STREAMS + 1];
+    uint64_t total[256];
+
+    huffman_segment_histograms(input, len, begin, counts, total);
+    for (unsigned c = 0; c < 256; c++) {
+        stats->count[c] = (size_t)total[c];
+    }
+
+    stats->len = len;
+    stats->distinct = 0;
+    for (unsigned c = 0; c < 256; c++) {
+        stats->distinct += stats->count[c] != 0;
+    }
+    stats->entropy = byte_entropy(stats->count, len);
+
+    stats->estimate[CODEC_RAW] = len;
+    stats->estimate[CODEC_RLE] = rle_encoded_size(input, len, &stats->runs, &stats->run_bytes);
+    stats->estimate[CODEC_LZ77] = lz77_sampled_size(input, len);
+    stats->estimate[CODEC_HUFFMAN] = huffman_encoded_size(counts, total, len, stats->distinct);
+}
+
+codec_choice_t codec_select(const codec_stats_t* stats) {
+    codec_choice_t best = CODEC_RAW;
+    size_t best_size = stats->len - stats->len / CODEC_MIN_GAIN;
+
+    for (int c = CODEC_RLE; c < CODEC_COUNT; c++) {
+        if (stats->estimate[c] < best_size) {
+            best = (codec_choice_t)c;
+            best_size = stats->estimate[c];
+        }
+    }
+    return best;
+}
+
+const char* codec_choice_name(codec_choice_t choice) {
+    return choice < CODEC_COUNT ? codec_choice_names[choice] : "unknown";
 }
@@ -2,8 +2,497 @@
 
 #define COMPRESSING_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+// shortest run worth a run token, shorter ones stay in literal segments
+#define RLE_MIN_RUN 3
+
 void rle_encode(const char* input, char* output);
 
+/**
+ * @brief Decode rle_encode output into a buffer of exactly rle_decoded_len(input) + 1 bytes
+ *
+ * @param input
+ * @return char* NUL-terminated string (free with free()), NULL on allocation error
+ **/
 char* rle_decode(const char* input);
 
+/**
+ * @brief Exact length of the string rle_decode returns, without decoding it
+ *
+ * @param input rle_encode output
+ * @return size_t
+ **/
+size_t rle_decoded_len(const char* input);
+
+/**
+ * @brief Decode rle_encode output into a caller buffer, runs are expanded with memset
+ *
+ * @param input rle_encode output
+ * @param output
+ * @param capacity output size including the terminating NUL
+ * @param written decoded length without the NUL
+ * @return int 0 on success, -1 with errno ENOSPC if output is too small
+ **/
+int rle_decode_into(const char* input, char* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Worst-case size of rle_encode_bytes output
+ *
+ * @param len input length
+ * @return size_t
+ **/
+size_t rle_bound(size_t len);
+
+/**
+ * @brief Binary-safe RLE encoding
+ *
+ * The output is a sequence of segments, each starting with a LEB128 varint (length << 1 | literal):
+ * a run segment is followed by the repeated byte, a literal segment by length raw bytes.
+ * Run boundaries are found 64 (AVX-512BW) or 32 (AVX2) bytes at a time when supported, literal
+ * stretches between runs are copied in bulk.
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size, rle_bound(len) always suffices
+ * @param written encoded length
+ * @return int 0 on success, -1 with errno ENOSPC if output is too small
+ **/
+int rle_encode_bytes(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief rle_encode_bytes with byte-at-a-time run detection, same output
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity
+ * @param written
+ * @return int 0 on success, -1 with errno ENOSPC if output is too small
+ **/
+int rle_encode_bytes_scalar(
+    const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Decode rle_encode_bytes output
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size
+ * @param written decoded length
+ * @return int 0 on success, -1 with errno EINVAL on malformed input or ENOSPC if output is too small
+ **/
+int rle_decode_bytes(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Exact decoded size of rle_encode_bytes output, from the segment headers only
+ *
+ * @param input
+ * @param len
+ * @param size
+ * @return int 0 on success, -1 with errno EINVAL on malformed input
+ **/
+int rle_decoded_size(const uint8_t* input, size_t len, size_t* size);
+
+/**
+ * @brief Incremental decoder of rle_encode_bytes output into a fixed output window
+ *
+ * @param input encoded data
+ * @param len
+ * @param pos next unread input byte
+ * @param pending bytes left in the current segment
+ * @param value byte of the current run
+ * @param literal current segment is a literal
+ **/
+typedef struct {
+    const uint8_t* input;
+    size_t len;
+    size_t pos;
+    uint64_t pending;
+    uint8_t value;
+    int literal;
+} rle_window_t;
+
+/**
+ * @brief Start decoding
+ *
+ * @param window
+ * @param input
+ * @param len
+ **/
+void rle_window_init(rle_window_t* window, const uint8_t* input, size_t len);
+
+/**
+ * @brief Decode the next bytes into the window, runs and literals may span several calls
+ *
+ * @param window
+ * @param output
+ * @param capacity window size
+ * @param written bytes produced, less than capacity only at the end of the input
+ * @return int 0 on success, -1 with errno EINVAL on malformed input
+ **/
+int rle_window_decode(rle_window_t* window, uint8_t* output, size_t capacity, size_t* written);
+
+#define RLE_STREAM_BUFFER 65536
+
+/**
+ * @brief Stream output callback
+ *
+ * @param ctx
+ * @param data
+ * @param len
+ * @return int 0 on success, -1 to abort the stream (errno is passed through)
+ **/
+typedef int (*rle_sink_fn)(void* ctx, const uint8_t* data, size_t len);
+
+/**
+ * @brief Streaming encoder of the rle_encode_bytes format, memory use is O(buffer_size)
+ *
+ * A run reaching the end of a chunk stays open until a later byte differs, literal bytes are
+ * staged until a run or a full buffer ends the segment.
+ *
+ * @param sink
+ * @param ctx
+ * @param out output buffer, handed to sink when full
+ * @param out_len
+ * @param literal pending literal bytes
+ * @param literal_len
+ * @param buffer_size size of both buffers
+ * @param run_len length of the run carried into the next chunk
+ * @param run_value
+ **/
+typedef struct {
+    rle_sink_fn sink;
+    void* ctx;
+    uint8_t* out;
+    size_t out_len;
+    uint8_t* literal;
+    size_t literal_len;
+    size_t buffer_size;
+    uint64_t run_len;
+    uint8_t run_value;
+} rle_encoder_t;
+
+/**
+ * @brief Streaming decoder of the rle_encode_bytes format, memory use is O(buffer_size)
+ *
+ * @param sink
+ * @param ctx
+ * @param out output buffer, handed to sink when full
+ * @param out_len
+ * @param buffer_size
+ * @param token segment header read so far
+ * @param shift bits of token read so far
+ * @param pending bytes left in the current segment
+ * @param literal current segment is a literal
+ * @param need_value run header read, run byte not yet
+ * @param value
+ **/
+typedef struct {
+    rle_sink_fn sink;
+    void* ctx;
+    uint8_t* out;
+    size_t out_len;
+    size_t buffer_size;
+    uint64_t token;
+    unsigned shift;
+    uint64_t pending;
+    int literal;
+    int need_value;
+    uint8_t value;
+} rle_decoder_t;
+
+/**
+ * @brief Initialize streaming encoder
+ *
+ * @param enc
+ * @param buffer_size at least 10, e.g. RLE_STREAM_BUFFER
+ * @param sink
+ * @param ctx passed to sink
+ * @return int 0 on success, -1 on invalid size or allocation error (errno is set)
+ **/
+int rle_encoder_init(rle_encoder_t* enc, size_t buffer_size, rle_sink_fn sink, void* ctx);
+
+/**
+ * @brief Encode the next chunk of input, chunks may have any size
+ *
+ * @param enc
+ * @param data
+ * @param len
+ * @return int 0 on success, -1 on sink error
+ **/
+int rle_encoder_write(rle_encoder_t* enc, const uint8_t* data, size_t len);
+
+/**
+ * @brief End the stream: close the open run and literal, flush the output buffer
+ *
+ * @param enc
+ * @return int 0 on success, -1 on sink error
+ **/
+int rle_encoder_finish(rle_encoder_t* enc);
+
+/**
+ * @brief Free encoder buffers
+ *
+ * @param enc
+ **/
+void rle_encoder_free(rle_encoder_t* enc);
+
+/**
+ * @brief Initialize streaming decoder
+ *
+ * @param dec
+ * @param buffer_size output buffer size, e.g. RLE_STREAM_BUFFER
+ * @param sink
+ * @param ctx passed to sink
+ * @return int 0 on success, -1 on invalid size or allocation error (errno is set)
+ **/
+int rle_decoder_init(rle_decoder_t* dec, size_t buffer_size, rle_sink_fn sink, void* ctx);
+
+/**
+ * @brief Decode the next chunk of encoded data, segments may span chunks
+ *
+ * @param dec
+ * @param data
+ * @param len
+ * @return int 0 on success, -1 with errno EINVAL on malformed input or on sink error
+ **/
+int rle_decoder_write(rle_decoder_t* dec, const uint8_t* data, size_t len);
+
+/**
+ * @brief End the stream and flush the output buffer
+ *
+ * @param dec
+ * @return int 0 on success, -1 with errno EINVAL if the input stopped inside a segment or on sink error
+ **/
+int rle_decoder_finish(rle_decoder_t* dec);
+
+/**
+ * @brief Free decoder buffer
+ *
+ * @param dec
+ **/
+void rle_decoder_free(rle_decoder_t* dec);
+
+/**
+ * @brief Encode everything read from in_fd to out_fd
+ *
+ * @param in_fd
+ * @param out_fd
+ * @param buffer_size read and write buffer size
+ * @return int 0 on success, -1 on I/O or allocation error (errno is set)
+ **/
+int rle_encode_fd(int in_fd, int out_fd, size_t buffer_size);
+
+/**
+ * @brief Decode everything read from in_fd to out_fd
+ *
+ * @param in_fd
+ * @param out_fd
+ * @param buffer_size read and write buffer size
+ * @return int 0 on success, -1 on malformed input, I/O or allocation error (errno is set)
+ **/
+int rle_decode_fd(int in_fd, int out_fd, size_t buffer_size);
+
+// LZ77 block format (LZ4 style): sequences of token, literals, 16-bit offset, match length
+#define LZ77_MIN_MATCH 4
+#define LZ77_MAX_OFFSET 65535
+#define LZ77_HASH_BITS 12
+
+/**
+ * @brief Worst-case size of lz77_encode output
+ *
+ * @param len input length
+ * @return size_t
+ **/
+size_t lz77_bound(size_t len);
+
+/**
+ * @brief Fast LZ77 encoding with a single-probe hash table
+ *
+ * Each sequence is a token (literal length << 4 | match length - 4, 15 meaning more length bytes
+ * follow, 255 per byte), the literals, a little-endian 16-bit offset and the extra length bytes.
+ * The last sequence has literals only. Matches are found by a Fibonacci hash of the next 4 bytes,
+ * positions that keep missing are skipped faster, so incompressible data passes through quickly.
+ *
+ * @param input at most 4 GB
+ * @param len
+ * @param output
+ * @param capacity output size, lz77_bound(len) always suffices
+ * @param written encoded length
+ * @return int 0 on success, -1 with errno ENOSPC if output is too small or EINVAL if input is too big
+ **/
+int lz77_encode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Decode lz77_encode output
+ *
+ * Every length and offset is checked against both buffers, copies far from the ends move 8 or 16
+ * bytes at a time and may write up to 16 bytes past the sequence (never past capacity).
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size
+ * @param written decoded length
+ * @return int 0 on success, -1 with errno EINVAL on malformed input or ENOSPC if output is too small
+ **/
+int lz77_decode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+// canonical Huffman codes are limited to the decode table width, every symbol takes one lookup
+#define HUFFMAN_MAX_BITS 11
+#define HUFFMAN_STREAMS 4
+
+/**
+ * @brief Worst-case size of huffman_encode output
+ *
+ * @param len input length
+ * @return size_t
+ **/
+size_t huffman_bound(size_t len);
+
+/**
+ * @brief Canonical Huffman entropy coding of bytes, e.g. as second stage after RLE or LZ77
+ *
+ * Header: mode byte and LEB128 length. Coded blocks carry 256 4-bit code lengths and the byte sizes
+ * of the first HUFFMAN_STREAMS - 1 bitstreams. The input is split into HUFFMAN_STREAMS equal parts,
+ * each coded LSB-first into its own bitstream, so the decoder can follow all of them at once.
+ * Inputs of a single byte value, or that Huffman would not shrink, are stored as run or raw.
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size, huffman_bound(len) always suffices
+ * @param written encoded length
+ * @return int 0 on success, -1 with errno ENOSPC if output is too small
+ **/
+int huffman_encode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Decoded size of huffman_encode output, from the header only
+ *
+ * @param input
+ * @param len
+ * @param size
+ * @return int 0 on success, -1 with errno EINVAL on malformed input
+ **/
+int huffman_decoded_size(const uint8_t* input, size_t len, size_t* size);
+
+/**
+ * @brief Decode huffman_encode output
+ *
+ * A 2^HUFFMAN_MAX_BITS entry table maps the next code bits to symbol and length. The streams are
+ * decoded interleaved, 5 symbols per 64-bit refill, so the lookups of different streams overlap.
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size
+ * @param written decoded length
+ * @return int 0 on success, -1 with errno EINVAL on malformed input or ENOSPC if output is too small
+ **/
+int huffman_decode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Worst-case size of lz77_huffman_encode output
+ *
+ * @param len input length
+ * @return size_t
+ **/
+size_t lz77_huffman_bound(size_t len);
+
+/**
+ * @brief LZ77 followed by the Huffman stage over its output
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size, lz77_huffman_bound(len) always suffices
+ * @param written encoded length
+ * @return int 0 on success, -1 with errno ENOSPC, EINVAL (input over 4 GB) or ENOMEM
+ **/
+int lz77_huffman_encode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Decode lz77_huffman_encode output
+ *
+ * @param input
+ * @param len
+ * @param output
+ * @param capacity output size
+ * @param written decoded length
+ * @return int 0 on success, -1 with errno EINVAL on malformed input, ENOSPC or ENOMEM
+ **/
+int lz77_huffman_decode(const uint8_t* input, size_t len, uint8_t* output, size_t capacity, size_t* written);
+
+// sampled LZ77 estimate: CODEC_SAMPLE_WINDOW bytes out of every CODEC_SAMPLE_STRIDE are parsed
+#define CODEC_SAMPLE_WINDOW 4096
+#define CODEC_SAMPLE_STRIDE 16384
+// a codec must save at least 1/CODEC_MIN_GAIN of the block, otherwise it is stored raw
+#define CODEC_MIN_GAIN 64
+
+typedef enum {
+    CODEC_RAW,        // store as is
+    CODEC_RLE,        // rle_encode_bytes
+    CODEC_LZ77,       // lz77_encode
+    CODEC_HUFFMAN,    // huffman_encode
+    CODEC_COUNT
+} codec_choice_t;
+
+/**
+ * @brief Block statistics and estimated encoded sizes, filled by codec_stats
+ *
+ * @param count byte histogram
+ * @param len
+ * @param entropy Shannon entropy in bits per byte
+ * @param distinct byte values that occur
+ * @param runs runs of RLE_MIN_RUN or more equal bytes
+ * @param run_bytes bytes covered by those runs
+ * @param estimate encoded size per codec_choice_t (RLE and Huffman exact, LZ77 sampled)
+ **/
+typedef struct {
+    size_t count[256];
+    size_t len;
+    double entropy;
+    unsigned distinct;
+    size_t runs;
+    size_t run_bytes;
+    size_t estimate[CODEC_COUNT];
+} codec_stats_t;
+
+/**
+ * @brief Analyze a block without encoding it
+ *
+ * Byte histograms of the Huffman stream segments give entropy and the exact Huffman size, the RLE
+ * run scan gives run statistics and the exact RLE size, and the LZ77 match finder runs over
+ * a quarter of the block. Incompressible data costs little: the scans move at memory speed and
+ * the match finder skips ahead on misses.
+ *
+ * @param input
+ * @param len
+ * @param stats
+ **/
+void codec_stats(const uint8_t* input, size_t len, codec_stats_t* stats);
+
+/**
+ * @brief Pick the codec with the smallest estimate, CODEC_RAW unless it saves 1/CODEC_MIN_GAIN
+ *
+ * Ties go to the codec with the faster decoder (RLE, then LZ77, then Huffman).
+ *
+ * @param stats codec_stats result
+ * @return codec_choice_t
+ **/
+codec_choice_t codec_select(const codec_stats_t* stats);
+
+/**
+ * @brief Get codec choice name
+ *
+ * @param choice
+ * @return const char*
+ **/
+const char* codec_choice_name(codec_choice_t choice);
+
 #endif    // !COMPRESSING_H
@@ -0,0 +1,782 @@
+// O_DIRECT
+#define _GNU_SOURCE
+#include "container.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checksum.h"
+#include "compressing.h"
+#include "crc32c.h"
+#include "threadpool.h"
+
+// mkstemp template appended to the output path
+#define CONTAINER_TEMP_SUFFIX ".XXXXXX"
+
+// task t handles block first + t and uses slot t of scratch
+typedef struct {
+    const uint8_t* input;
+    size_t len;
+    uint32_t block_size;
+    container_codec_t codec;
+    checksum_algo_t checksum;
+    uint8_t* scratch;
+    size_t slot_size;
+    container_block_t* blocks;
+    size_t first;
+    int failed;
+} container_compress_job_t;
+
+// task t decodes block first + t to output + t * block_size
+typedef struct {
+    const container_reader_t* reader;
+    uint8_t* output;
+    uint64_t first;
+    int error;
+} container_decompress_job_t;
+
+// sequential output file: data is gathered in an aligned CONTAINER_WRITE_CHUNK buffer, full chunks
+// go out with O_DIRECT while the file allows it, the unaligned tail through the page cache
+typedef struct {
+    const char* path;
+    char* target;
+    char* temp_path;
+    int fd;
+    int direct;
+    size_t direct_len;
+    uint8_t* buffer;
+    size_t fill;
+} container_writer_t;
+
+static const char* const container_codec_names[] = {
+    [CONTAINER_CODEC_STORE] = "store",
+    [CONTAINER_CODEC_RLE] = "rle",
+    [CONTAINER_CODEC_LZ77] = "lz77",
+    [CONTAINER_CODEC_LZ77_HUFFMAN] = "lz77-huffman",
+    [CONTAINER_CODEC_HUFFMAN] = "huffman",
+    [CONTAINER_CODEC_AUTO] = "auto",
+};
+
+static const container_codec_t container_choice_codecs[CODEC_COUNT] = {
+    [CODEC_RAW] = CONTAINER_CODEC_STORE,
+    [CODEC_RLE] = CONTAINER_CODEC_RLE,
+    [CODEC_LZ77] = CONTAINER_CODEC_LZ77,
+    [CODEC_HUFFMAN] = CONTAINER_CODEC_HUFFMAN,
+};
+
+static inline size_t container_align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+// every block holds block_size raw bytes except a shorter last one
+static inline uint64_t container_raw_len(uint64_t len, uint32_t block_size, uint64_t block) {
+    uint64_t rest = len - block * block_size;
+    return rest < block_size ? rest : block_size;
+}
+
+static inline size_t container_max(size_t a, size_t b) {
+    return a > b ? a : b;
+}
+
+static int container_params_valid(container_codec_t codec, checksum_algo_t checksum, uint32_t block_size) {
+    return block_size > 0 && block_size <= CONTAINER_MAX_BLOCK && codec <= CONTAINER_CODEC_AUTO
+           && (checksum == CHECKSUM_FLETCHER32 || checksum == CHECKSUM_CRC32C);
+}
+
+static size_t container_bound(container_codec_t codec, size_t len) {
+    switch (codec) {
+        case CONTAINER_CODEC_RLE:
+            return rle_bound(len);
+        case CONTAINER_CODEC_LZ77:
+            return lz77_bound(len);
+        case CONTAINER_CODEC_LZ77_HUFFMAN:
+            return lz77_huffman_bound(len);
+        case CONTAINER_CODEC_HUFFMAN:
+            return huffman_bound(len);
+        case CONTAINER_CODEC_AUTO:
+            return container_max(rle_bound(len), container_max(lz77_bound(len), huffman_bound(len)));
+        default:
+            return len;
+    }
+}
+
+int container_codec_from_name(const char* name, container_codec_t* codec) {
+    for (size_t i = 0; i < sizeof(container_codec_names) / sizeof(container_codec_names[0]); i++) {
+        if (strcmp(name, container_codec_names[i]) == 0) {
+            *codec = (container_codec_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* container_codec_name(container_codec_t codec) {
+    return codec <= CONTAINER_CODEC_AUTO ? container_codec_names[codec] : "unknown";
+}
+
+// blocks the codec cannot shrink are stored raw, with CONTAINER_CODEC_AUTO codec_select decides
+// per block and blocks it judges incompressible are never run through a codec
+static void container_compress_task(void* ctx, size_t task) {
+    container_compress_job_t* job = (container_compress_job_t*)ctx;
+    size_t index = job->first + task;
+    const uint8_t* raw = job->input + index * job->block_size;
+    size_t raw_len = container_raw_len(job->len, job->block_size, index);
+    uint8_t* slot = job->scratch + task * job->slot_size;
+    container_block_t* block = &job->blocks[index];
+    container_codec_t codec = job->codec;
+    size_t written = raw_len;
+
+    block->raw_len = (uint32_t)raw_len;
+    block->checksum = checksum_sum32(job->checksum, raw, raw_len);
+    block->codec = CONTAINER_CODEC_STORE;
+
+    if (codec == CONTAINER_CODEC_AUTO) {
+        codec_stats_t stats;
+        codec_stats(raw, raw_len, &stats);
+        codec = container_choice_codecs[codec_select(&stats)];
+    }
+
+    int rc = 0;
+    if (codec == CONTAINER_CODEC_RLE) {
+        rc = rle_encode_bytes(raw, raw_len, slot, job->slot_size, &written);
+    } else if (codec == CONTAINER_CODEC_LZ77) {
+        rc = lz77_encode(raw, raw_len, slot, job->slot_size, &written);
+    } else if (codec == CONTAINER_CODEC_LZ77_HUFFMAN) {
+        rc = lz77_huffman_encode(raw, raw_len, slot, job->slot_size, &written);
+    } else if (codec == CONTAINER_CODEC_HUFFMAN) {
+        rc = huffman_encode(raw, raw_len, slot, job->slot_size, &written);
+    }
+    if (rc < 0) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (codec != CONTAINER_CODEC_STORE && written < raw_len) {
+        block->codec = codec;
+    } else {
+        memcpy(slot, raw, raw_len);
+        written = raw_len;
+    }
+    block->compressed_len = (uint32_t)written;
+}
+
+int container_compress(
+    const uint8_t* input,
+    size_t len,
+    container_codec_t codec,
+    checksum_algo_t checksum,
+    uint32_t block_size,
+    unsigned nthreads,
+    uint8_t** output,
+    size_t* output_len) {
+    *output = NULL;
+    *output_len = 0;
+    if (!container_params_valid(codec, checksum, block_size)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t nblocks = (len + block_size - 1) / block_size;
+    container_compress_job_t job = {
+        .input = input,
+        .len = len,
+        .block_size = block_size,
+        .codec = codec,
+        .checksum = checksum,
+        .slot_size = container_bound(codec, block_size),
+        .first = 0,
+        .failed = 0,
+    };
+
+    // every block gets a worst-case slot, the container is packed from them afterwards
+    job.scratch = malloc(nblocks ? nblocks * job.slot_size : 1);
+    job.blocks = calloc(nblocks ? nblocks : 1, sizeof(container_block_t));
+    if (!job.scratch || !job.blocks) {
+        free(job.scratch);
+        free(job.blocks);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    threadpool_run(nblocks, container_compress_task, &job, nthreads);
+    if (job.failed) {
+        free(job.scratch);
+        free(job.blocks);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    size_t offset = sizeof(container_header_t);
+    for (size_t i = 0; i < nblocks; i++) {
+        job.blocks[i].offset = offset;
+        offset += job.blocks[i].compressed_len;
+    }
+    size_t index_offset = container_align8(offset);
+    size_t total = index_offset + nblocks * sizeof(container_block_t) + sizeof(container_trailer_t);
+
+    uint8_t* out = calloc(total, 1);
+    if (!out) {
+        free(job.scratch);
+        free(job.blocks);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    container_header_t header = {
+        .magic = CONTAINER_MAGIC,
+        .version = CONTAINER_VERSION,
+        .block_size = block_size,
+        .checksum = (uint32_t)checksum,
+    };
+    memcpy(out, &header, sizeof(header));
+    for (size_t i = 0; i < nblocks; i++) {
+        memcpy(out + job.blocks[i].offset, job.scratch + i * job.slot_size, job.blocks[i].compressed_len);
+    }
+    memcpy(out + index_offset, job.blocks, nblocks * sizeof(container_block_t));
+
+    container_trailer_t trailer = {
+        .index_offset = index_offset,
+        .nblocks = nblocks,
+        .raw_len = len,
+        .index_crc = crc32c(0, job.blocks, nblocks * sizeof(container_block_t)),
+        .magic = CONTAINER_MAGIC,
+    };
+    memcpy(out + total - sizeof(trailer), &trailer, sizeof(trailer));
+
+    free(job.scratch);
+    free(job.blocks);
+    *output = out;
+    *output_len = total;
+    return 0;
+}
+
+int container_open(container_reader_t* reader, const uint8_t* data, size_t len) {
+    memset(reader, 0, sizeof(*reader));
+    if (len < sizeof(container_header_t) + sizeof(container_trailer_t) || ((uintptr_t)data & 7)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    const container_header_t* header = (const container_header_t*)data;
+    size_t index_end = len - sizeof(container_trailer_t);
+    const container_trailer_t* trailer = (const container_trailer_t*)(data + index_end);
+
+    if (header->magic != CONTAINER_MAGIC || header->version != CONTAINER_VERSION
+        || trailer->magic != CONTAINER_MAGIC || header->block_size == 0
+        || (header->checksum != CHECKSUM_FLETCHER32 && header->checksum != CHECKSUM_CRC32C)
+        || header->block_size > CONTAINER_MAX_BLOCK || trailer->index_offset < sizeof(container_header_t)
+        || trailer->index_offset > index_end || (trailer->index_offset & 7)
+        || trailer->nblocks != (index_end - trailer->index_offset) / sizeof(container_block_t)
+        || (index_end - trailer->index_offset) % sizeof(container_block_t) != 0
+        || trailer->nblocks
+               != trailer->raw_len / header->block_size + (trailer->raw_len % header->block_size != 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    const container_block_t* blocks = (const container_block_t*)(data + trailer->index_offset);
+    if (crc32c(0, blocks, trailer->nblocks * sizeof(container_block_t)) != trailer->index_crc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // every block must lie between the header and the index and have its expected raw size
+    for (uint64_t i = 0; i < trailer->nblocks; i++) {
+        if (blocks[i].offset < sizeof(container_header_t) || blocks[i].offset > trailer->index_offset
+            || blocks[i].compressed_len > trailer->index_offset - blocks[i].offset
+            || blocks[i].raw_len != container_raw_len(trailer->raw_len, header->block_size, i)
+            || blocks[i].codec > CONTAINER_CODEC_HUFFMAN) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    reader->data = data;
+    reader->len = len;
+    reader->header = header;
+    reader->blocks = blocks;
+    reader->nblocks = trailer->nblocks;
+    reader->raw_len = trailer->raw_len;
+    return 0;
+}
+
+uint64_t container_block_of(const container_reader_t* reader, uint64_t offset) {
+    return offset / reader->header->block_size;
+}
+
+int container_read_block(
+    const container_reader_t* reader, uint64_t block, uint8_t* output, size_t capacity, size_t* written) {
+    *written = 0;
+    if (block >= reader->nblocks) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    const container_block_t* entry = &reader->blocks[block];
+    const uint8_t* data = reader->data + entry->offset;
+    size_t raw_len = 0;
+
+    if (capacity < entry->raw_len) {
+        errno = ENOSPC;
+        return -1;
+    }
+    if (entry->codec == CONTAINER_CODEC_STORE) {
+        if (entry->compressed_len != entry->raw_len) {
+            errno = EINVAL;
+            return -1;
+        }
+        memcpy(output, data, entry->raw_len);
+        raw_len = entry->raw_len;
+    } else if (entry->codec == CONTAINER_CODEC_RLE) {
+        if (rle_decode_bytes(data, entry->compressed_len, output, entry->raw_len, &raw_len) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+    } else if (entry->codec == CONTAINER_CODEC_LZ77) {
+        if (lz77_decode(data, entry->compressed_len, output, entry->raw_len, &raw_len) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+    } else if (entry->codec == CONTAINER_CODEC_HUFFMAN) {
+        if (huffman_decode(data, entry->compressed_len, output, entry->raw_len, &raw_len) < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+    } else if (lz77_huffman_decode(data, entry->compressed_len, output, entry->raw_len, &raw_len) < 0) {
+        if (errno != ENOMEM) {
+            errno = EINVAL;
+        }
+        return -1;
+    }
+
+    if (raw_len != entry->raw_len
+        || checksum_sum32((checksum_algo_t)reader->header->checksum, output, raw_len) != entry->checksum) {
+        errno = EINVAL;
+        return -1;
+    }
+    *written = raw_len;
+    return 0;
+}
+
+static void container_decompress_task(void* ctx, size_t task) {
+    container_decompress_job_t* job = (container_decompress_job_t*)ctx;
+    const container_reader_t* reader = job->reader;
+    uint64_t block = job->first + task;
+    uint8_t* output = job->output + task * reader->header->block_size;
+    size_t written;
+
+    if (container_read_block(reader, block, output, reader->blocks[block].raw_len, &written) < 0) {
+        __atomic_store_n(&job->error, errno, __ATOMIC_RELAXED);
+    }
+}
+
+int container_decompress(const container_reader_t* reader, uint8_t* output, unsigned nthreads) {
+    container_decompress_job_t job = {
+        .reader = reader,
+        .output = output,
+        .first = 0,
+        .error = 0,
+    };
+
+    threadpool_run(reader->nblocks, container_decompress_task, &job, nthreads);
+    if (job.error) {
+        errno = job.error;
+        return -1;
+    }
+    return 0;
+}
+
+// empty files cannot be mapped, they read as this (8-byte aligned) buffer
+static const uint64_t container_empty[1] = { 0 };
+
+static int container_map_file(const char* path, const uint8_t** data, size_t* len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    *len = (size_t)st.st_size;
+    if (*len == 0) {
+        close(fd);
+        *data = (const uint8_t*)container_empty;
+        return 0;
+    }
+
+    void* map = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        errno = err;
+        return -1;
+    }
+
+    madvise(map, *len, MADV_SEQUENTIAL);
+    *data = map;
+    return 0;
+}
+
+// pages below end are not read again, dropping them keeps resident memory flat on huge files
+static size_t container_release_pages(const uint8_t* data, size_t released, size_t end) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    end -= end % page;
+    if (end > released) {
+        madvise((void*)(data + released), end - released, MADV_DONTNEED);
+        return end;
+    }
+    return released;
+}
+
+static void container_unmap_file(const uint8_t* data, size_t len) {
+    if (len > 0) {
+        munmap((void*)data, len);
+    }
+}
+
+static int container_write_all(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, data, len < CONTAINER_WRITE_CHUNK ? len : CONTAINER_WRITE_CHUNK);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+// regular files are written to a temporary file beside them and renamed into place on success, so the
+// input may be the output and a failed run leaves an existing file alone; devices are written in place
+static int container_writer_open(container_writer_t* writer, const char* path, int direct) {
+    struct stat st;
+
+    memset(writer, 0, sizeof(*writer));
+    writer->path = path;
+    writer->fd = -1;
+    if (posix_memalign((void**)&writer->buffer, CONTAINER_DIRECT_ALIGN, CONTAINER_WRITE_CHUNK) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    if (stat(path, &st) == 0 && !S_ISREG(st.st_mode)) {
+        writer->fd = open(path, O_WRONLY | O_TRUNC);
+    } else {
+        // an existing output is replaced where it really lives, not at a symlink pointing there
+        writer->target = realpath(path, NULL);
+        const char* target = writer->target ? writer->target : path;
+        size_t len = strlen(target);
+        writer->temp_path = malloc(len + sizeof(CONTAINER_TEMP_SUFFIX));
+        if (!writer->temp_path) {
+            free(writer->target);
+            free(writer->buffer);
+            errno = ENOMEM;
+            return -1;
+        }
+        memcpy(writer->temp_path, target, len);
+        memcpy(writer->temp_path + len, CONTAINER_TEMP_SUFFIX, sizeof(CONTAINER_TEMP_SUFFIX));
+        writer->fd = mkstemp(writer->temp_path);
+        if (writer->fd >= 0 && fchmod(writer->fd, 0644) < 0) {
+            int err = errno;
+            close(writer->fd);
+            unlink(writer->temp_path);
+            writer->fd = -1;
+            errno = err;
+        }
+    }
+    if (writer->fd < 0) {
+        int err = errno;
+        free(writer->target);
+        free(writer->temp_path);
+        free(writer->buffer);
+        errno = err;
+        return -1;
+    }
+
+#ifdef O_DIRECT
+    // file systems without O_DIRECT (tmpfs) reject the flag and get buffered writes
+    if (direct) {
+        writer->direct = fcntl(writer->fd, F_SETFL, fcntl(writer->fd, F_GETFL) | O_DIRECT) == 0;
+    }
+#else
+    (void)direct;
+#endif
+    return 0;
+}
+
+static int container_writer_flush(container_writer_t* writer) {
+    size_t done = 0;
+
+#ifdef O_DIRECT
+    if (writer->direct) {
+        // EINVAL: the device rejects the alignment, the rest is buffered like the unaligned tail
+        size_t direct_len = writer->fill & ~(size_t)(CONTAINER_DIRECT_ALIGN - 1);
+        if (container_write_all(writer->fd, writer->buffer, direct_len) == 0) {
+            done = direct_len;
+            writer->direct_len += direct_len;
+        } else if (errno != EINVAL) {
+            return -1;
+        }
+        if (done < writer->fill) {
+            if (fcntl(writer->fd, F_SETFL, fcntl(writer->fd, F_GETFL) & ~O_DIRECT) < 0) {
+                return -1;
+            }
+            writer->direct = 0;
+        }
+    }
+#endif
+    if (container_write_all(writer->fd, writer->buffer + done, writer->fill - done) < 0) {
+        return -1;
+    }
+    writer->fill = 0;
+    return 0;
+}
+
+static int container_writer_append(container_writer_t* writer, const void* data, size_t len) {
+    const uint8_t* bytes = data;
+
+    while (len > 0) {
+        size_t n = CONTAINER_WRITE_CHUNK - writer->fill < len ? CONTAINER_WRITE_CHUNK - writer->fill : len;
+        memcpy(writer->buffer + writer->fill, bytes, n);
+        writer->fill += n;
+        bytes += n;
+        len -= n;
+        if (writer->fill == CONTAINER_WRITE_CHUNK && container_writer_flush(writer) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// writes the tail and closes the file, the temporary file replaces the output unless anything failed
+static int container_writer_close(container_writer_t* writer, int rc) {
+    if (rc == 0) {
+        rc = container_writer_flush(writer);
+    }
+
+    int err = errno;
+    if (close(writer->fd) < 0 && rc == 0) {
+        rc = -1;
+        err = errno;
+    }
+    const char* target = writer->target ? writer->target : writer->path;
+    if (rc == 0 && writer->temp_path && rename(writer->temp_path, target) < 0) {
+        rc = -1;
+        err = errno;
+    }
+    if (rc < 0 && writer->temp_path) {
+        unlink(writer->temp_path);
+    }
+    free(writer->target);
+    free(writer->temp_path);
+    free(writer->buffer);
+    errno = err;
+    return rc;
+}
+
+// a few blocks per worker keep the pool busy while only one batch is held in memory
+static size_t container_batch_blocks(unsigned nthreads, uint64_t nblocks) {
+    size_t batch = (size_t)(nthreads ? nthreads : threadpool_default_threads()) * CONTAINER_BATCH_PER_THREAD;
+    if (nblocks < batch) {
+        return nblocks ? (size_t)nblocks : 1;
+    }
+    return batch;
+}
+
+int container_compress_file(
+    const char* input_path,
+    const char* output_path,
+    container_codec_t codec,
+    checksum_algo_t checksum,
+    uint32_t block_size,
+    unsigned nthreads,
+    int direct,
+    container_file_stats_t* stats) {
+    static const uint8_t padding[8] = { 0 };
+    const uint8_t* input;
+    container_writer_t writer;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!container_params_valid(codec, checksum, block_size)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (container_map_file(input_path, &input, &stats->input_len) < 0) {
+        return -1;
+    }
+
+    size_t len = stats->input_len;
+    size_t nblocks = (len + block_size - 1) / block_size;
+    size_t batch = container_batch_blocks(nthreads, nblocks);
+    container_compress_job_t job = {
+        .input = input,
+        .len = len,
+        .block_size = block_size,
+        .codec = codec,
+        .checksum = checksum,
+        .slot_size = container_bound(codec, block_size),
+        .failed = 0,
+    };
+
+    // worst-case slots for one batch, the index of all blocks stays until the end
+    job.scratch = malloc(batch * job.slot_size);
+    job.blocks = calloc(nblocks ? nblocks : 1, sizeof(container_block_t));
+    int rc = 0;
+    if (!job.scratch || !job.blocks) {
+        errno = ENOMEM;
+        rc = -1;
+    }
+    if (rc == 0) {
+        rc = container_writer_open(&writer, output_path, direct);
+    }
+    if (rc == 0) {
+        container_header_t header = {
+            .magic = CONTAINER_MAGIC,
+            .version = CONTAINER_VERSION,
+            .block_size = block_size,
+            .checksum = (uint32_t)checksum,
+        };
+        size_t offset = sizeof(header);
+        size_t released = 0;
+
+        rc = container_writer_append(&writer, &header, sizeof(header));
+        for (job.first = 0; rc == 0 && job.first < nblocks; job.first += batch) {
+            size_t count = nblocks - job.first < batch ? nblocks - job.first : batch;
+            threadpool_run(count, container_compress_task, &job, nthreads);
+            if (job.failed) {
+                errno = ENOMEM;
+                rc = -1;
+                break;
+            }
+            for (size_t i = 0; rc == 0 && i < count; i++) {
+                container_block_t* block = &job.blocks[job.first + i];
+                block->offset = offset;
+                offset += block->compressed_len;
+                rc = container_writer_append(&writer, job.scratch + i * job.slot_size, block->compressed_len);
+            }
+            size_t end = (job.first + count) * block_size;
+            released = container_release_pages(input, released, end < len ? end : len);
+        }
+
+        size_t index_offset = container_align8(offset);
+        size_t index_len = nblocks * sizeof(container_block_t);
+        container_trailer_t trailer = {
+            .index_offset = index_offset,
+            .nblocks = nblocks,
+            .raw_len = len,
+            .index_crc = crc32c(0, job.blocks, index_len),
+            .magic = CONTAINER_MAGIC,
+        };
+        if (rc == 0) {
+            rc = container_writer_append(&writer, padding, index_offset - offset);
+        }
+        if (rc == 0) {
+            rc = container_writer_append(&writer, job.blocks, index_len);
+        }
+        if (rc == 0) {
+            rc = container_writer_append(&writer, &trailer, sizeof(trailer));
+        }
+        rc = container_writer_close(&writer, rc);
+        stats->output_len = index_offset + index_len + sizeof(trailer);
+        stats->direct = writer.direct_len > 0;
+    }
+
+    int err = errno;
+    free(job.scratch);
+    free(job.blocks);
+    container_unmap_file(input, len);
+    if (rc < 0) {
+        errno = err;
+        return -1;
+    }
+    stats->nblocks = nblocks;
+    return 0;
+}
+
+int container_decompress_file(
+    const char* input_path,
+    const char* output_path,
+    unsigned nthreads,
+    int direct,
+    container_file_stats_t* stats) {
+    const uint8_t* input;
+    container_reader_t reader;
+    container_writer_t writer;
+    uint8_t* output = NULL;
+    size_t batch = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    if (container_map_file(input_path, &input, &stats->input_len) < 0) {
+        return -1;
+    }
+
+    // one batch of raw blocks is decoded at a time and written out in block order
+    int rc = container_open(&reader, input, stats->input_len);
+    if (rc == 0) {
+        batch = container_batch_blocks(nthreads, reader.nblocks);
+        output = malloc(batch * reader.header->block_size);
+        if (!output) {
+            errno = ENOMEM;
+            rc = -1;
+        }
+    }
+    if (rc == 0) {
+        rc = container_writer_open(&writer, output_path, direct);
+    }
+    if (rc == 0) {
+        container_decompress_job_t job = {
+            .reader = &reader,
+            .output = output,
+            .error = 0,
+        };
+        size_t released = 0;
+
+        for (job.first = 0; rc == 0 && job.first < reader.nblocks; job.first += batch) {
+            size_t count = reader.nblocks - job.first < batch ? (size_t)(reader.nblocks - job.first) : batch;
+            threadpool_run(count, container_decompress_task, &job, nthreads);
+            if (job.error) {
+                errno = job.error;
+                rc = -1;
+                break;
+            }
+
+            size_t raw_len = 0;
+            for (size_t i = 0; i < count; i++) {
+                raw_len += reader.blocks[job.first + i].raw_len;
+            }
+            rc = container_writer_append(&writer, output, raw_len);
+
+            const container_block_t* last = &reader.blocks[job.first + count - 1];
+            released = container_release_pages(input, released, last->offset + last->compressed_len);
+        }
+        rc = container_writer_close(&writer, rc);
+        stats->output_len = reader.raw_len;
+        stats->direct = writer.direct_len > 0;
+    }
+
+    int err = errno;
+    free(output);
+    container_unmap_file(input, stats->input_len);
+    if (rc < 0) {
+        errno = err;
+        return -1;
+    }
+    stats->nblocks = reader.nblocks;
+    return 0;
+}
@@ -0,0 +1,246 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "checksum.h"
+
+#define CONTAINER_MAGIC 0x43464f41u    // "AOFC"
+#define CONTAINER_VERSION 1
+#define CONTAINER_DEFAULT_BLOCK (1u << 20)
+#define CONTAINER_MAX_BLOCK (1u << 30)
+// container files are written in chunks of this size, O_DIRECT chunks are multiples of the alignment
+#define CONTAINER_WRITE_CHUNK (8u << 20)
+#define CONTAINER_DIRECT_ALIGN 4096
+// the file modes compress or decompress this many blocks per worker at a time
+#define CONTAINER_BATCH_PER_THREAD 4
+
+typedef enum {
+    CONTAINER_CODEC_STORE,           // raw bytes, also used for blocks the codec would expand
+    CONTAINER_CODEC_RLE,             // rle_encode_bytes
+    CONTAINER_CODEC_LZ77,            // lz77_encode
+    CONTAINER_CODEC_LZ77_HUFFMAN,    // lz77_encode, then huffman_encode of its output
+    CONTAINER_CODEC_HUFFMAN,         // huffman_encode
+    CONTAINER_CODEC_AUTO             // compression only: codec_select per block (store, RLE, LZ77, Huffman)
+} container_codec_t;
+
+/**
+ * @brief Container header, followed by the compressed blocks, the block index and the trailer
+ *
+ * Layout: header | block 0 | ... | block n-1 | padding to 8 | index (n entries) | trailer.
+ * Fields are stored in host byte order, like the mphf format.
+ *
+ * @param magic CONTAINER_MAGIC
+ * @param version CONTAINER_VERSION
+ * @param block_size raw bytes per block (the last block may be shorter)
+ * @param checksum checksum_algo_t of the per-block sums
+ **/
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t block_size;
+    uint32_t checksum;
+    uint64_t reserved[2];
+} container_header_t;
+
+/**
+ * @brief Block index entry
+ *
+ * @param offset compressed block position from the start of the container
+ * @param compressed_len
+ * @param raw_len
+ * @param checksum sum of the raw block
+ * @param codec container_codec_t of the block
+ **/
+typedef struct {
+    uint64_t offset;
+    uint32_t compressed_len;
+    uint32_t raw_len;
+    uint32_t checksum;
+    uint32_t codec;
+} container_block_t;
+
+/**
+ * @brief Trailer at the very end, a reader starts here
+ *
+ * @param index_offset position of the block index, 8-byte aligned
+ * @param nblocks
+ * @param raw_len total decompressed size
+ * @param index_crc crc32c of the block index
+ * @param magic CONTAINER_MAGIC
+ **/
+typedef struct {
+    uint64_t index_offset;
+    uint64_t nblocks;
+    uint64_t raw_len;
+    uint32_t index_crc;
+    uint32_t magic;
+} container_trailer_t;
+
+/**
+ * @brief Validated view of a container in memory
+ *
+ * @param data container bytes, 8-byte aligned (malloc or mmap)
+ * @param len
+ * @param header
+ * @param blocks block index
+ * @param nblocks
+ * @param raw_len total decompressed size
+ **/
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    const container_header_t* header;
+    const container_block_t* blocks;
+    uint64_t nblocks;
+    uint64_t raw_len;
+} container_reader_t;
+
+/**
+ * @brief Sizes and write mode of a container_compress_file / container_decompress_file run
+ *
+ * @param input_len bytes read
+ * @param output_len bytes written
+ * @param nblocks container blocks
+ * @param direct 1 if the output bypassed the page cache through O_DIRECT
+ **/
+typedef struct {
+    size_t input_len;
+    size_t output_len;
+    uint64_t nblocks;
+    int direct;
+} container_file_stats_t;
+
+/**
+ * @brief Parse codec name (store, rle, lz77, lz77-huffman, huffman, auto)
+ *
+ * @param name
+ * @param codec parsed codec
+ * @return int 0 on success, -1 on unknown name
+ **/
+int container_codec_from_name(const char* name, container_codec_t* codec);
+
+/**
+ * @brief Get codec name
+ *
+ * @param codec
+ * @return const char*
+ **/
+const char* container_codec_name(container_codec_t codec);
+
+/**
+ * @brief Split input into blocks, compress them on a thread pool and frame them with an index
+ *
+ * @param input
+ * @param len
+ * @param codec
+ * @param checksum CHECKSUM_FLETCHER32 or CHECKSUM_CRC32C
+ * @param block_size raw bytes per block, 1..CONTAINER_MAX_BLOCK
+ * @param nthreads number of workers (0 = all CPUs)
+ * @param output container (free with free())
+ * @param output_len
+ * @return int 0 on success, -1 with errno EINVAL or ENOMEM
+ **/
+int container_compress(
+    const uint8_t* input,
+    size_t len,
+    container_codec_t codec,
+    checksum_algo_t checksum,
+    uint32_t block_size,
+    unsigned nthreads,
+    uint8_t** output,
+    size_t* output_len);
+
+/**
+ * @brief Check trailer, header and index of a container
+ *
+ * @param reader
+ * @param data 8-byte aligned container bytes, must outlive the reader
+ * @param len
+ * @return int 0 on success, -1 with errno EINVAL on a damaged or foreign container
+ **/
+int container_open(container_reader_t* reader, const uint8_t* data, size_t len);
+
+/**
+ * @brief Block holding a raw offset
+ *
+ * @param reader
+ * @param offset decompressed position, below raw_len
+ * @return uint64_t block number
+ **/
+uint64_t container_block_of(const container_reader_t* reader, uint64_t offset);
+
+/**
+ * @brief Decompress and verify one block
+ *
+ * @param reader
+ * @param block block number
+ * @param output
+ * @param capacity at least the block's raw_len (header block_size always suffices)
+ * @param written raw_len of the block
+ * @return int 0 on success, -1 with errno EINVAL on corrupt data or checksum mismatch, ENOSPC, ENOMEM
+ **/
+int container_read_block(
+    const container_reader_t* reader, uint64_t block, uint8_t* output, size_t capacity, size_t* written);
+
+/**
+ * @brief Decompress and verify all blocks on a thread pool
+ *
+ * @param reader
+ * @param output raw_len bytes
+ * @param nthreads number of workers (0 = all CPUs)
+ * @return int 0 on success, -1 with errno EINVAL on corrupt data or checksum mismatch, ENOMEM
+ **/
+int container_decompress(const container_reader_t* reader, uint8_t* output, unsigned nthreads);
+
+/**
+ * @brief Memory-map a file, compress it in the container format and write the container to a file
+ *
+ * Blocks are compressed in batches of CONTAINER_BATCH_PER_THREAD per worker and each batch is
+ * appended to the output before the next one starts, so memory holds one batch and the block index;
+ * input pages are dropped once their blocks are written. The output is written sequentially in
+ * CONTAINER_WRITE_CHUNK pieces. With direct set it is opened with O_DIRECT where the platform and
+ * file system allow it, only the unaligned tail goes through the page cache; otherwise buffered
+ * writes are used.
+ *
+ * @param input_path
+ * @param output_path replaced on success only, may name the input
+ * @param codec
+ * @param checksum CHECKSUM_FLETCHER32 or CHECKSUM_CRC32C
+ * @param block_size raw bytes per block, 1..CONTAINER_MAX_BLOCK
+ * @param nthreads number of workers (0 = all CPUs)
+ * @param direct request O_DIRECT output
+ * @param stats
+ * @return int 0 on success, -1 on error (errno is set)
+ **/
+int container_compress_file(
+    const char* input_path,
+    const char* output_path,
+    container_codec_t codec,
+    checksum_algo_t checksum,
+    uint32_t block_size,
+    unsigned nthreads,
+    int direct,
+    container_file_stats_t* stats);
+
+/**
+ * @brief Memory-map a container file, verify and decompress it and write the raw bytes to a file
+ *
+ * Decodes batches of blocks like container_compress_file and writes each one before the next.
+ *
+ * @param input_path
+ * @param output_path replaced on success only, may name the input
+ * @param nthreads number of workers (0 = all CPUs)
+ * @param direct request O_DIRECT output, see container_compress_file
+ * @param stats
+ * @return int 0 on success, -1 on error (errno is set, EINVAL for a damaged container)
+ **/
+int container_decompress_file(
+    const char* input_path,
+    const char* output_path,
+    unsigned nthreads,
+    int direct,
+    container_file_stats_t* stats);
+
+#endif    // CONTAINER_H
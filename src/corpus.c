@@ -0,0 +1,183 @@
+#include "corpus.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "algos.h"
+
+#define CORPUS_MAX_WORD 12
+
+static const char* corpus_names[CORPUS_KIND_COUNT] = {"zipf-text", "runs", "random", "sorted-ints"};
+
+// letters by English frequency, squared uniform draws favour the front
+static const char corpus_letters[] = "etaoinshrdlcumwfgypbvkjxqz";
+
+void corpus_default_params(corpus_kind_t kind, corpus_params_t* params) {
+    memset(params, 0, sizeof(*params));
+    params->kind = kind;
+    params->zipf_exponent = 1.0;
+    params->vocabulary = 10000;
+    params->mean_run = 16.0;
+    params->alphabet = kind == CORPUS_RANDOM ? 256 : 16;
+    params->max_step = 64;
+}
+
+const char* corpus_kind_name(corpus_kind_t kind) {
+    return kind < CORPUS_KIND_COUNT ? corpus_names[kind] : "unknown";
+}
+
+static int corpus_zipf_text(const corpus_params_t* params, uint8_t* output, size_t len, uint64_t* seed) {
+    uint32_t n = params->vocabulary;
+    double* cdf = malloc(n * sizeof(double));
+    char* words = malloc((size_t)n * CORPUS_MAX_WORD);
+    uint8_t* lengths = malloc(n);
+    double total = 0;
+
+    if (!cdf || !words || !lengths) {
+        free(cdf);
+        free(words);
+        free(lengths);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    // frequent (low rank) words are short, like in natural language
+    for (uint32_t r = 0; r < n; r++) {
+        unsigned max_len = 2 + (unsigned)log2(r + 2.0);
+        total += pow(r + 1.0, -params->zipf_exponent);
+        cdf[r] = total;
+        lengths[r] = (uint8_t)rand_range(seed, 1, max_len < CORPUS_MAX_WORD ? max_len : CORPUS_MAX_WORD);
+        for (unsigned i = 0; i < lengths[r]; i++) {
+            double u = rand_double(seed);
+            words[(size_t)r * CORPUS_MAX_WORD + i] = corpus_letters[(size_t)(u * u * 26)];
+        }
+    }
+
+    for (size_t pos = 0; pos < len;) {
+        double u = rand_double(seed) * total;
+        uint32_t lo = 0;
+        uint32_t hi = n - 1;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (cdf[mid] > u) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        size_t word_len = len - pos < lengths[lo] ? len - pos : lengths[lo];
+        memcpy(output + pos, words + (size_t)lo * CORPUS_MAX_WORD, word_len);
+        pos += word_len;
+        if (pos < len) {
+            output[pos++] = (xorshift64(seed) & 15) ? ' ' : '\n';
+        }
+    }
+
+    free(cdf);
+    free(words);
+    free(lengths);
+    return 0;
+}
+
+// geometric run lengths: floor(log(u) / log(1 - 1/mean)) + 1 has the requested mean
+static void corpus_runs(const corpus_params_t* params, uint8_t* output, size_t len, uint64_t* seed) {
+    double q = params->mean_run > 1.0 ? log(1.0 - 1.0 / params->mean_run) : 0.0;
+
+    for (size_t pos = 0; pos < len;) {
+        size_t run = 1;
+        if (q < 0.0) {
+            run += (size_t)(log(1.0 - rand_double(seed)) / q);
+        }
+        if (run > len - pos) {
+            run = len - pos;
+        }
+        memset(output + pos, (int)rand_range(seed, 0, params->alphabet - 1), run);
+        pos += run;
+    }
+}
+
+static void corpus_random(const corpus_params_t* params, uint8_t* output, size_t len, uint64_t* seed) {
+    size_t pos = 0;
+
+    if (params->alphabet == 256) {
+        for (; pos + 8 <= len; pos += 8) {
+            uint64_t v = xorshift64(seed);
+            memcpy(output + pos, &v, sizeof(v));
+        }
+    }
+    for (; pos < len; pos++) {
+        output[pos] = (uint8_t)rand_range(seed, 0, params->alphabet - 1);
+    }
+}
+
+static void corpus_sorted_ints(const corpus_params_t* params, uint8_t* output, size_t len, uint64_t* seed) {
+    uint32_t value = (uint32_t)xorshift64(seed) >> 8;
+
+    for (size_t pos = 0; pos < len; pos += sizeof(value)) {
+        value += (uint32_t)rand_range(seed, 0, params->max_step);
+        memcpy(output + pos, &value, len - pos < sizeof(value) ? len - pos : sizeof(value));
+    }
+}
+
+int corpus_generate(const corpus_params_t* params, uint8_t* output, size_t len, uint64_t seed) {
+    uint64_t state = seed ? seed : 0x9e3779b97f4a7c15ULL;
+
+    switch (params->kind) {
+        case CORPUS_ZIPF_TEXT:
+            if (params->vocabulary == 0 || params->zipf_exponent < 0.0) {
+                break;
+            }
+            return corpus_zipf_text(params, output, len, &state);
+        case CORPUS_RUNS:
+            if (params->alphabet == 0 || params->alphabet > 256) {
+                break;
+            }
+            corpus_runs(params, output, len, &state);
+            return 0;
+        case CORPUS_RANDOM:
+            if (params->alphabet == 0 || params->alphabet > 256) {
+                break;
+            }
+            corpus_random(params, output, len, &state);
+            return 0;
+        case CORPUS_SORTED_INTS:
+            corpus_sorted_ints(params, output, len, &state);
+            return 0;
+        default:
+            break;
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+int corpus_parse_size(const char* text, size_t* size) {
+    char* end;
+    unsigned shift = 0;
+
+    if (*text < '0' || *text > '9') {
+        return -1;
+    }
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno) {
+        return -1;
+    }
+    if (*end == 'K' || *end == 'k') {
+        shift = 10;
+    } else if (*end == 'M' || *end == 'm') {
+        shift = 20;
+    } else if (*end == 'G' || *end == 'g') {
+        shift = 30;
+    }
+    end += shift ? 1 : 0;
+
+    if (*end != '\0' || value == 0 || value > (SIZE_MAX >> shift)) {
+        return -1;
+    }
+    *size = (size_t)value << shift;
+    return 0;
+}
@@ -0,0 +1,72 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CORPUS_DEFAULT_SIZE (4u << 20)
+
+typedef enum {
+    CORPUS_ZIPF_TEXT,      // words drawn by Zipf rank from a random vocabulary
+    CORPUS_RUNS,           // byte runs with geometric lengths
+    CORPUS_RANDOM,         // independent uniform bytes
+    CORPUS_SORTED_INTS,    // increasing little-endian uint32 values
+    CORPUS_KIND_COUNT
+} corpus_kind_t;
+
+/**
+ * @brief Shape of a synthetic corpus
+ *
+ * @param kind
+ * @param zipf_exponent text: word frequency falls as rank^-exponent (about 1 for natural language)
+ * @param vocabulary text: distinct words
+ * @param mean_run runs: mean run length, 1 gives no runs
+ * @param alphabet runs, random: distinct byte values, log2(alphabet) bits of entropy per symbol
+ * @param max_step sorted integers: gaps are uniform in [0, max_step]
+ **/
+typedef struct {
+    corpus_kind_t kind;
+    double zipf_exponent;
+    uint32_t vocabulary;
+    double mean_run;
+    uint32_t alphabet;
+    uint32_t max_step;
+} corpus_params_t;
+
+/**
+ * @brief Default parameters of a corpus kind
+ *
+ * @param kind
+ * @param params
+ **/
+void corpus_default_params(corpus_kind_t kind, corpus_params_t* params);
+
+/**
+ * @brief Short name of a corpus kind
+ *
+ * @param kind
+ * @return const char*
+ **/
+const char* corpus_kind_name(corpus_kind_t kind);
+
+/**
+ * @brief Fill a buffer of any size with synthetic data (xorshift64 driven, reproducible by seed)
+ *
+ * @param params
+ * @param output
+ * @param len
+ * @param seed
+ * @return int 0 on success, -1 with errno EINVAL on bad parameters or ENOMEM
+ **/
+int corpus_generate(const corpus_params_t* params, uint8_t* output, size_t len, uint64_t seed);
+
+/**
+ * @brief Parse a size with optional K, M or G suffix (powers of 1024), e.g. "64K", "1G"
+ *
+ * @param text
+ * @param size
+ * @return int 0 on success, -1 on malformed or zero size
+ **/
+int corpus_parse_size(const char* text, size_t* size);
+
+#endif    // CORPUS_H
@@ -0,0 +1,193 @@
+#include "countmin.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "algos.h"
+
+// items whose counter rows are prefetched before the first of them is updated
+#define CMS_BATCH 32
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// row r uses h1 + r * h2 (Kirsch-Mitzenmacher), h2 is odd so rows never collapse
+static inline uint32_t cms_row_hash(uint64_t hash, uint32_t row) {
+    return (uint32_t)hash + row * ((uint32_t)(hash >> 32) | 1);
+}
+
+static inline size_t cms_offset(const cms_t* cms, uint32_t row, uint32_t g) {
+    return (size_t)row * cms->width + (g & (cms->width - 1));
+}
+
+// count-sketch sign from the top bit, which the index (width <= 2^30) never uses
+static inline uint32_t cms_signed(uint32_t g, uint32_t count) {
+    uint32_t negate = (uint32_t)((int32_t)g >> 31);
+    return (count ^ negate) - negate;
+}
+
+int cms_init(cms_t* cms, cms_kind_t kind, uint32_t width, uint32_t depth) {
+    memset(cms, 0, sizeof(*cms));
+    if (width == 0 || (width & (width - 1)) || width > CMS_MAX_WIDTH || depth == 0 || depth > CMS_MAX_DEPTH) {
+        return -1;
+    }
+
+    cms->counters = calloc((size_t)width * depth, sizeof(uint32_t));
+    if (!cms->counters) {
+        return -1;
+    }
+    cms->width = width;
+    cms->depth = depth;
+    cms->kind = kind;
+    return 0;
+}
+
+void cms_free(cms_t* cms) {
+    free(cms->counters);
+    memset(cms, 0, sizeof(*cms));
+}
+
+void cms_add_hash(cms_t* cms, uint64_t hash, uint32_t count) {
+    for (uint32_t row = 0; row < cms->depth; row++) {
+        uint32_t g = cms_row_hash(hash, row);
+        uint32_t delta = cms->kind == CMS_COUNT_SKETCH ? cms_signed(g, count) : count;
+        cms->counters[cms_offset(cms, row, g)] += delta;
+    }
+}
+
+void cms_add(cms_t* cms, const void* data, size_t len, uint32_t count) {
+    cms_add_hash(cms, murmur3_x64_64(data, len, 0), count);
+}
+
+void cms_add_hash_batch(cms_t* cms, const uint64_t* hashes, size_t n) {
+    for (size_t pos = 0; pos < n; pos += CMS_BATCH) {
+        size_t len = n - pos < CMS_BATCH ? n - pos : CMS_BATCH;
+
+        // counters of a big sketch are cache misses, start all of them before the first update
+        for (size_t i = 0; i < len; i++) {
+            for (uint32_t row = 0; row < cms->depth; row++) {
+                uint32_t g = cms_row_hash(hashes[pos + i], row);
+                __builtin_prefetch(&cms->counters[cms_offset(cms, row, g)], 1);
+            }
+        }
+        for (size_t i = 0; i < len; i++) {
+            cms_add_hash(cms, hashes[pos + i], 1);
+        }
+    }
+}
+
+static int64_t cms_median(int64_t* values, uint32_t n) {
+    for (uint32_t i = 1; i < n; i++) {
+        int64_t v = values[i];
+        uint32_t j = i;
+        while (j > 0 && values[j - 1] > v) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = v;
+    }
+    return n & 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+// row minimum with 8 gathers per round
+AVX2_TARGET static int64_t cms_min_avx2(const cms_t* cms, uint64_t hash) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i h1 = _mm256_set1_epi32((int)(uint32_t)hash);
+    const __m256i h2 = _mm256_set1_epi32((int)((uint32_t)(hash >> 32) | 1));
+    const __m256i mask = _mm256_set1_epi32((int)(cms->width - 1));
+    const __m256i width = _mm256_set1_epi32((int)cms->width);
+    __m256i min = _mm256_set1_epi32(-1);
+
+    // row offsets fit in 32 bits for every sketch up to 2^31 counters, the rest takes the scalar path
+    for (uint32_t row = 0; row < cms->depth; row += 8) {
+        __m256i rows = _mm256_add_epi32(_mm256_set1_epi32((int)row), lanes);
+        __m256i active = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)cms->depth), rows);
+        __m256i g = _mm256_add_epi32(h1, _mm256_mullo_epi32(rows, h2));
+        __m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(rows, width), _mm256_and_si256(g, mask));
+        __m256i values = _mm256_mask_i32gather_epi32(
+            _mm256_set1_epi32(-1), (const int*)cms->counters, offset, active, 4);
+        min = _mm256_min_epu32(min, values);
+    }
+
+    __m128i m = _mm_min_epu32(_mm256_castsi256_si128(min), _mm256_extracti128_si256(min, 1));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(m);
+}
+
+int64_t cms_estimate_hash(const cms_t* cms, uint64_t hash) {
+    return cms_estimate_merged(cms, 1, hash);
+}
+
+int64_t cms_estimate(const cms_t* cms, const void* data, size_t len) {
+    return cms_estimate_hash(cms, murmur3_x64_64(data, len, 0));
+}
+
+AVX2_TARGET static void cms_add_counters_avx2(uint32_t* dst, const uint32_t* src, size_t n) {
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi32(a, b));
+    }
+    for (; i < n; i++) {
+        dst[i] += src[i];
+    }
+}
+
+int cms_merge(cms_t* dst, const cms_t* src) {
+    size_t n = (size_t)dst->width * dst->depth;
+
+    if (dst->kind != src->kind || dst->width != src->width || dst->depth != src->depth) {
+        return -1;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        cms_add_counters_avx2(dst->counters, src->counters, n);
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        dst->counters[i] += src->counters[i];
+    }
+    return 0;
+}
+
+int64_t cms_estimate_merged(const cms_t* sketches, size_t count, uint64_t hash) {
+    const cms_t* first = &sketches[0];
+    int64_t values[CMS_MAX_DEPTH];
+
+    // no sketch has seen the key
+    if (count == 0) {
+        return 0;
+    }
+    if (count == 1 && first->kind == CMS_COUNT_MIN && (size_t)first->width * first->depth <= INT32_MAX
+        && __builtin_cpu_supports("avx2")) {
+        return cms_min_avx2(first, hash);
+    }
+
+    for (uint32_t row = 0; row < first->depth; row++) {
+        uint32_t g = cms_row_hash(hash, row);
+        size_t offset = cms_offset(first, row, g);
+        uint32_t sum = 0;
+
+        for (size_t s = 0; s < count; s++) {
+            sum += sketches[s].counters[offset];
+        }
+        values[row] = first->kind == CMS_COUNT_SKETCH ? (int32_t)cms_signed(g, sum) : (int64_t)sum;
+    }
+
+    if (first->kind == CMS_COUNT_SKETCH) {
+        return cms_median(values, first->depth);
+    }
+
+    int64_t min = INT64_MAX;
+    for (uint32_t row = 0; row < first->depth; row++) {
+        min = values[row] < min ? values[row] : min;
+    }
+    return min;
+}
+
+size_t cms_memory(const cms_t* cms) {
+    return (size_t)cms->width * cms->depth * sizeof(uint32_t);
+}
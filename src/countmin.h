@@ -0,0 +1,124 @@
+#ifndef COUNTMIN_H
+#define COUNTMIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CMS_MAX_DEPTH 16
+#define CMS_MAX_WIDTH (1u << 30)
+
+typedef enum {
+    CMS_COUNT_MIN,      // unsigned counters, estimate is the row minimum (never underestimates)
+    CMS_COUNT_SKETCH    // signed counters, estimate is the row median (unbiased)
+} cms_kind_t;
+
+/**
+ * @brief Count-Min / Count-Sketch frequency sketch
+ *
+ * Row indexes come from one 64-bit hash (h1 + row * h2), counters are 32-bit.
+ *
+ * @param counters depth rows of width counters
+ * @param width counters per row, power of two
+ * @param depth number of rows
+ * @param kind
+ **/
+typedef struct {
+    uint32_t* counters;
+    uint32_t width;
+    uint32_t depth;
+    cms_kind_t kind;
+} cms_t;
+
+/**
+ * @brief Initialize empty sketch
+ *
+ * @param cms
+ * @param kind
+ * @param width power of two up to CMS_MAX_WIDTH, error is about stream_length * e / width
+ * @param depth 1..CMS_MAX_DEPTH, failure probability is about exp(-depth)
+ * @return int 0 on success, -1 on invalid size or allocation error
+ **/
+int cms_init(cms_t* cms, cms_kind_t kind, uint32_t width, uint32_t depth);
+
+/**
+ * @brief Free sketch
+ *
+ * @param cms
+ **/
+void cms_free(cms_t* cms);
+
+/**
+ * @brief Add count for 64-bit hash
+ *
+ * @param cms
+ * @param hash
+ * @param count
+ **/
+void cms_add_hash(cms_t* cms, uint64_t hash, uint32_t count);
+
+/**
+ * @brief Add count for byte string (hashed with murmur3_x64_64)
+ *
+ * @param cms
+ * @param data
+ * @param len
+ * @param count
+ **/
+void cms_add(cms_t* cms, const void* data, size_t len, uint32_t count);
+
+/**
+ * @brief Add one occurrence of many hashes, counter rows are prefetched ahead of the updates
+ *
+ * @param cms
+ * @param hashes
+ * @param n
+ **/
+void cms_add_hash_batch(cms_t* cms, const uint64_t* hashes, size_t n);
+
+/**
+ * @brief Estimate count of 64-bit hash (AVX2 gathers if supported)
+ *
+ * @param cms
+ * @param hash
+ * @return int64_t
+ **/
+int64_t cms_estimate_hash(const cms_t* cms, uint64_t hash);
+
+/**
+ * @brief Estimate count of byte string
+ *
+ * @param cms
+ * @param data
+ * @param len
+ * @return int64_t
+ **/
+int64_t cms_estimate(const cms_t* cms, const void* data, size_t len);
+
+/**
+ * @brief Add counters of src to dst (sketch of the combined streams)
+ *
+ * @param dst
+ * @param src same kind, width and depth as dst
+ * @return int 0 on success, -1 on shape mismatch
+ **/
+int cms_merge(cms_t* dst, const cms_t* src);
+
+/**
+ * @brief Estimate count over several sketches without merging them (e.g. one sketch per thread)
+ *
+ * @param sketches same kind, width and depth
+ * @param count number of sketches, 0 estimates 0
+ * @param hash
+ * @return int64_t
+ **/
+int64_t cms_estimate_merged(const cms_t* sketches, size_t count, uint64_t hash);
+
+/**
+ * @brief Memory used by the sketch in bytes
+ *
+ * @param cms
+ * @return size_t
+ **/
+size_t cms_memory(const cms_t* cms);
+
+#endif    // COUNTMIN_H
@@ -0,0 +1,192 @@
+#include "crc32c.h"
+
+#include <nmmintrin.h>
+#include <stdint.h>
+#include <string.h>
+
+// reflected Castagnoli polynomial
+#define CRC32C_POLY 0x82f63b78u
+
+// block sizes for the three-stream hardware path
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
+static uint32_t crc32c_table[8][256];
+
+// x^(2^n) mod p for n = 0..31, used to shift a crc over n zero bits
+static uint32_t crc32c_x2n_table[32];
+
+// operators shifting a raw crc over CRC32C_LONG / CRC32C_SHORT zero bytes
+static uint32_t crc32c_long[4][256];
+static uint32_t crc32c_short[4][256];
+
+// a(x) * b(x) mod p(x), bit 31 holds the x^0 coefficient
+static uint32_t multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+// x^(n * 2^k) mod p
+static uint32_t x2nmodp(size_t n, unsigned k) {
+    uint32_t p = 1u << 31;
+
+    while (n) {
+        if (n & 1) {
+            p = multmodp(crc32c_x2n_table[k & 31], p);
+        }
+        n >>= 1;
+        k++;
+    }
+    return p;
+}
+
+static void crc32c_zeros_table(uint32_t zeros[4][256], size_t len) {
+    uint32_t op = x2nmodp(len, 3);
+
+    for (uint32_t n = 0; n < 256; n++) {
+        for (int b = 0; b < 4; b++) {
+            zeros[b][n] = multmodp(op, n << (8 * b));
+        }
+    }
+}
+
+static inline uint32_t crc32c_shift(uint32_t zeros[4][256], uint32_t crc) {
+    return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff] ^ zeros[2][(crc >> 16) & 0xff]
+           ^ zeros[3][crc >> 24];
+}
+
+__attribute__((constructor)) static void crc32c_init_tables(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][n] = crc;
+    }
+
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = crc32c_table[0][n];
+        for (int k = 1; k < 8; k++) {
+            crc = crc32c_table[0][crc & 0xff] ^ (crc >> 8);
+            crc32c_table[k][n] = crc;
+        }
+    }
+
+    uint32_t p = 1u << 30;
+    crc32c_x2n_table[0] = p;
+    for (int n = 1; n < 32; n++) {
+        crc32c_x2n_table[n] = p = multmodp(p, p);
+    }
+
+    crc32c_zeros_table(crc32c_long, CRC32C_LONG);
+    crc32c_zeros_table(crc32c_short, CRC32C_SHORT);
+}
+
+uint32_t crc32c_sw(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+
+    while (len && ((uintptr_t)p & 7)) {
+        crc = crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        len--;
+    }
+
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        w ^= crc;
+        crc = crc32c_table[7][w & 0xff] ^ crc32c_table[6][(w >> 8) & 0xff] ^ crc32c_table[5][(w >> 16) & 0xff]
+              ^ crc32c_table[4][(w >> 24) & 0xff] ^ crc32c_table[3][(w >> 32) & 0xff]
+              ^ crc32c_table[2][(w >> 40) & 0xff] ^ crc32c_table[1][(w >> 48) & 0xff]
+              ^ crc32c_table[0][w >> 56];
+        p += 8;
+        len -= 8;
+    }
+
+    while (len--) {
+        crc = crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// crc32 has 3 cycles latency and 1 cycle throughput: three independent
+// streams keep the unit busy, their crcs are then merged by shifting
+__attribute__((target("sse4.2"))) static inline uint64_t crc32c_hw_blocks(
+    uint64_t crc0, const uint8_t** next, size_t* len, size_t block, uint32_t zeros[4][256]) {
+    while (*len >= block * 3) {
+        const uint8_t* p = *next;
+        const uint8_t* end = p + block;
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+
+        do {
+            uint64_t w0, w1, w2;
+            memcpy(&w0, p, sizeof(w0));
+            memcpy(&w1, p + block, sizeof(w1));
+            memcpy(&w2, p + 2 * block, sizeof(w2));
+            crc0 = _mm_crc32_u64(crc0, w0);
+            crc1 = _mm_crc32_u64(crc1, w1);
+            crc2 = _mm_crc32_u64(crc2, w2);
+            p += 8;
+        } while (p < end);
+
+        crc0 = crc32c_shift(zeros, (uint32_t)crc0) ^ crc1;
+        crc0 = crc32c_shift(zeros, (uint32_t)crc0) ^ crc2;
+        *next += block * 3;
+        *len -= block * 3;
+    }
+    return crc0;
+}
+
+__attribute__((target("sse4.2"))) uint32_t crc32c_hw(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* next = (const uint8_t*)data;
+    uint64_t crc0 = ~crc;
+
+    while (len && ((uintptr_t)next & 7)) {
+        crc0 = _mm_crc32_u8((uint32_t)crc0, *next++);
+        len--;
+    }
+
+    crc0 = crc32c_hw_blocks(crc0, &next, &len, CRC32C_LONG, crc32c_long);
+    crc0 = crc32c_hw_blocks(crc0, &next, &len, CRC32C_SHORT, crc32c_short);
+
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, next, sizeof(w));
+        crc0 = _mm_crc32_u64(crc0, w);
+        next += 8;
+        len -= 8;
+    }
+
+    while (len--) {
+        crc0 = _mm_crc32_u8((uint32_t)crc0, *next++);
+    }
+    return ~(uint32_t)crc0;
+}
+
+int crc32c_hw_available(void) {
+    return __builtin_cpu_supports("sse4.2");
+}
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t len) {
+    if (crc32c_hw_available()) {
+        return crc32c_hw(crc, data, len);
+    }
+    return crc32c_sw(crc, data, len);
+}
+
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, size_t len2) {
+    return multmodp(x2nmodp(len2, 3), crc1) ^ crc2;
+}
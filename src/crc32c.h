@@ -0,0 +1,58 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC32C (Castagnoli) checksum, picks SSE4.2 path at runtime when available
+ *
+ * Chaining is supported: crc32c(crc32c(0, a), b) == crc32c(0, a || b)
+ *
+ * @param crc previous crc (0 for the first chunk)
+ * @param data
+ * @param len
+ * @return uint32_t
+ **/
+uint32_t crc32c(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief CRC32C by slicing-by-8 lookup tables (portable path)
+ *
+ * @param crc previous crc (0 for the first chunk)
+ * @param data
+ * @param len
+ * @return uint32_t
+ **/
+uint32_t crc32c_sw(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief CRC32C by SSE4.2 crc32 instruction, three interleaved streams
+ *
+ * Must only be called when crc32c_hw_available() returns non-zero.
+ *
+ * @param crc previous crc (0 for the first chunk)
+ * @param data
+ * @param len
+ * @return uint32_t
+ **/
+uint32_t crc32c_hw(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief Check that CPU supports the SSE4.2 crc32 instruction
+ *
+ * @return int
+ **/
+int crc32c_hw_available(void);
+
+/**
+ * @brief Combine CRCs of two consecutive chunks into CRC of their concatenation
+ *
+ * @param crc1 crc32c of the first chunk
+ * @param crc2 crc32c of the second chunk
+ * @param len2 length of the second chunk
+ * @return uint32_t crc32c of first || second
+ **/
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, size_t len2);
+
+#endif    // CRC32C_H
@@ -0,0 +1,193 @@
+#include "cuckoo.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "algos.h"
+
+// lookups whose buckets are prefetched before the first of them is probed
+#define CUCKOO_BATCH 16
+
+static inline uint64_t cuckoo_fastrange(uint64_t x, uint64_t n) {
+    return (uint64_t)(((unsigned __int128)x * n) >> 64);
+}
+
+// fingerprint from the low bits, bucket from the high bits (fastrange), 0 marks an empty slot
+static inline uint16_t cuckoo_fingerprint(uint64_t hash) {
+    uint16_t fp = (uint16_t)hash;
+    return fp ? fp : 1;
+}
+
+static inline uint64_t cuckoo_alt_bucket(const cuckoo_filter_t* cf, uint64_t bucket, uint16_t fp) {
+    uint64_t t = cuckoo_fastrange(fmix64(fp), cf->num_buckets);
+    return t >= bucket ? t - bucket : t + cf->num_buckets - bucket;
+}
+
+// one 16-bit lane mask per slot of both buckets, 2 bits per lane
+static inline unsigned cuckoo_match(uint64_t b1, uint64_t b2, uint16_t fp) {
+    __m128i v = _mm_set_epi64x((long long)b2, (long long)b1);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_set1_epi16((short)fp)));
+}
+
+static inline int cuckoo_bucket_set(uint64_t* bucket, uint16_t fp) {
+    unsigned empty = cuckoo_match(*bucket, ~UINT64_C(0), 0);
+    if (!empty) {
+        return 0;
+    }
+    *bucket |= (uint64_t)fp << (__builtin_ctz(empty) * 8);
+    return 1;
+}
+
+static inline int cuckoo_bucket_clear(uint64_t* bucket, uint16_t fp) {
+    unsigned match = cuckoo_match(*bucket, 0, fp) & 0xff;
+    if (!match) {
+        return 0;
+    }
+    *bucket &= ~(UINT64_C(0xffff) << (__builtin_ctz(match) * 8));
+    return 1;
+}
+
+int cuckoo_init(cuckoo_filter_t* cf, size_t capacity) {
+    memset(cf, 0, sizeof(*cf));
+    uint64_t slots = ((uint64_t)capacity * 100 + CUCKOO_LOAD_PERCENT - 1) / CUCKOO_LOAD_PERCENT;
+    uint64_t num_buckets = (slots + CUCKOO_SLOTS - 1) / CUCKOO_SLOTS;
+
+    cf->num_buckets = num_buckets ? num_buckets : 1;
+    cf->buckets = calloc(cf->num_buckets, sizeof(uint64_t));
+    if (!cf->buckets) {
+        return -1;
+    }
+    cf->rng = 0x9e3779b97f4a7c15ULL;
+    return 0;
+}
+
+void cuckoo_free(cuckoo_filter_t* cf) {
+    free(cf->buckets);
+    memset(cf, 0, sizeof(*cf));
+}
+
+uint64_t cuckoo_hash_key(const void* key, size_t len) {
+    return fmix64(((uint64_t)fnv1a_hash(key, len) << 32) ^ len);
+}
+
+static int cuckoo_insert_fp(cuckoo_filter_t* cf, uint16_t fp, uint64_t bucket) {
+    // the victim slot holds the last homeless fingerprint, the filter is full while it is taken
+    if (cf->victim) {
+        return -1;
+    }
+    if (cuckoo_bucket_set(&cf->buckets[bucket], fp)) {
+        cf->count++;
+        return 0;
+    }
+    bucket = cuckoo_alt_bucket(cf, bucket, fp);
+    if (cuckoo_bucket_set(&cf->buckets[bucket], fp)) {
+        cf->count++;
+        return 0;
+    }
+
+    // random walk: swap fp with a random slot and move the evicted fingerprint to its other bucket
+    for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++) {
+        unsigned shift = (unsigned)(xorshift64(&cf->rng) % CUCKOO_SLOTS) * 16;
+        uint64_t* b = &cf->buckets[bucket];
+        uint16_t evicted = (uint16_t)(*b >> shift);
+
+        *b = (*b & ~(UINT64_C(0xffff) << shift)) | ((uint64_t)fp << shift);
+        fp = evicted;
+        bucket = cuckoo_alt_bucket(cf, bucket, fp);
+        if (cuckoo_bucket_set(&cf->buckets[bucket], fp)) {
+            cf->count++;
+            return 0;
+        }
+    }
+
+    // the new item is stored, one old fingerprint waits in the victim slot
+    cf->victim = fp;
+    cf->victim_bucket = bucket;
+    cf->count++;
+    return 0;
+}
+
+int cuckoo_insert_hash(cuckoo_filter_t* cf, uint64_t hash) {
+    return cuckoo_insert_fp(cf, cuckoo_fingerprint(hash), cuckoo_fastrange(hash, cf->num_buckets));
+}
+
+static inline int cuckoo_victim_matches(const cuckoo_filter_t* cf, uint16_t fp, uint64_t i1, uint64_t i2) {
+    return cf->victim == fp && (cf->victim_bucket == i1 || cf->victim_bucket == i2);
+}
+
+int cuckoo_contains_hash(const cuckoo_filter_t* cf, uint64_t hash) {
+    uint16_t fp = cuckoo_fingerprint(hash);
+    uint64_t i1 = cuckoo_fastrange(hash, cf->num_buckets);
+    uint64_t i2 = cuckoo_alt_bucket(cf, i1, fp);
+
+    return cuckoo_match(cf->buckets[i1], cf->buckets[i2], fp) != 0 || cuckoo_victim_matches(cf, fp, i1, i2);
+}
+
+int cuckoo_remove_hash(cuckoo_filter_t* cf, uint64_t hash) {
+    uint16_t fp = cuckoo_fingerprint(hash);
+    uint64_t i1 = cuckoo_fastrange(hash, cf->num_buckets);
+    uint64_t i2 = cuckoo_alt_bucket(cf, i1, fp);
+
+    if (cuckoo_victim_matches(cf, fp, i1, i2)) {
+        cf->victim = 0;
+        cf->count--;
+        return 1;
+    }
+    if (!cuckoo_bucket_clear(&cf->buckets[i1], fp) && !cuckoo_bucket_clear(&cf->buckets[i2], fp)) {
+        return 0;
+    }
+    cf->count--;
+
+    // a freed slot may give the victim a home again
+    if (cf->victim) {
+        uint16_t victim = cf->victim;
+        cf->victim = 0;
+        cf->count--;
+        cuckoo_insert_fp(cf, victim, cf->victim_bucket);
+    }
+    return 1;
+}
+
+void cuckoo_contains_batch(const cuckoo_filter_t* cf, const uint64_t* hashes, size_t n, uint8_t* out) {
+    uint64_t i1[CUCKOO_BATCH];
+    uint64_t i2[CUCKOO_BATCH];
+    uint16_t fp[CUCKOO_BATCH];
+
+    for (size_t pos = 0; pos < n; pos += CUCKOO_BATCH) {
+        size_t len = n - pos < CUCKOO_BATCH ? n - pos : CUCKOO_BATCH;
+
+        for (size_t i = 0; i < len; i++) {
+            fp[i] = cuckoo_fingerprint(hashes[pos + i]);
+            i1[i] = cuckoo_fastrange(hashes[pos + i], cf->num_buckets);
+            i2[i] = cuckoo_alt_bucket(cf, i1[i], fp[i]);
+            __builtin_prefetch(&cf->buckets[i1[i]]);
+            __builtin_prefetch(&cf->buckets[i2[i]]);
+        }
+        for (size_t i = 0; i < len; i++) {
+            out[pos + i] = cuckoo_match(cf->buckets[i1[i]], cf->buckets[i2[i]], fp[i]) != 0
+                           || cuckoo_victim_matches(cf, fp[i], i1[i], i2[i]);
+        }
+    }
+}
+
+int cuckoo_insert(cuckoo_filter_t* cf, const void* key, size_t len) {
+    return cuckoo_insert_hash(cf, cuckoo_hash_key(key, len));
+}
+
+int cuckoo_contains(const cuckoo_filter_t* cf, const void* key, size_t len) {
+    return cuckoo_contains_hash(cf, cuckoo_hash_key(key, len));
+}
+
+int cuckoo_remove(cuckoo_filter_t* cf, const void* key, size_t len) {
+    return cuckoo_remove_hash(cf, cuckoo_hash_key(key, len));
+}
+
+double cuckoo_load(const cuckoo_filter_t* cf) {
+    return (double)cf->count / ((double)cf->num_buckets * CUCKOO_SLOTS);
+}
+
+size_t cuckoo_memory(const cuckoo_filter_t* cf) {
+    return cf->num_buckets * sizeof(uint64_t);
+}
@@ -0,0 +1,142 @@
+#ifndef CUCKOO_H
+#define CUCKOO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CUCKOO_SLOTS 4
+#define CUCKOO_LOAD_PERCENT 95
+#define CUCKOO_MAX_KICKS 500
+
+/**
+ * @brief Cuckoo filter with 16-bit fingerprints and 4-slot buckets
+ *
+ * A bucket is one 64-bit word of 4 fingerprints (0 = empty slot). An item lives in bucket i1
+ * or i2 = (h(fp) - i1) mod num_buckets, so either index can be computed from the other and the
+ * fingerprint, and items can be relocated and deleted. False positive rate is about 8 / 2^16.
+ *
+ * @param buckets
+ * @param num_buckets any size, sized for CUCKOO_LOAD_PERCENT occupancy at capacity
+ * @param count stored fingerprints
+ * @param rng eviction slot choice
+ * @param victim fingerprint left over from a failed eviction chain (0 = none)
+ * @param victim_bucket
+ **/
+typedef struct {
+    uint64_t* buckets;
+    uint64_t num_buckets;
+    size_t count;
+    uint64_t rng;
+    uint16_t victim;
+    uint64_t victim_bucket;
+} cuckoo_filter_t;
+
+/**
+ * @brief Initialize empty filter
+ *
+ * @param cf
+ * @param capacity items the filter is expected to hold
+ * @return int 0 on success, -1 on allocation error
+ **/
+int cuckoo_init(cuckoo_filter_t* cf, size_t capacity);
+
+/**
+ * @brief Free filter
+ *
+ * @param cf
+ **/
+void cuckoo_free(cuckoo_filter_t* cf);
+
+/**
+ * @brief 64-bit hash of byte string (fnv1a_hash spread with fmix64)
+ *
+ * @param key
+ * @param len
+ * @return uint64_t
+ **/
+uint64_t cuckoo_hash_key(const void* key, size_t len);
+
+/**
+ * @brief Insert 64-bit hash
+ *
+ * @param cf
+ * @param hash
+ * @return int 0 on success, -1 if the filter is full
+ **/
+int cuckoo_insert_hash(cuckoo_filter_t* cf, uint64_t hash);
+
+/**
+ * @brief Test 64-bit hash, both buckets are probed with one SIMD comparison
+ *
+ * @param cf
+ * @param hash
+ * @return int 1 if possibly present, 0 if absent
+ **/
+int cuckoo_contains_hash(const cuckoo_filter_t* cf, uint64_t hash);
+
+/**
+ * @brief Remove 64-bit hash, only hashes that were inserted may be removed
+ *
+ * @param cf
+ * @param hash
+ * @return int 1 if removed, 0 if not found
+ **/
+int cuckoo_remove_hash(cuckoo_filter_t* cf, uint64_t hash);
+
+/**
+ * @brief Test many hashes, buckets are prefetched ahead of the probes
+ *
+ * @param cf
+ * @param hashes
+ * @param n
+ * @param out n results (1 = possibly present)
+ **/
+void cuckoo_contains_batch(const cuckoo_filter_t* cf, const uint64_t* hashes, size_t n, uint8_t* out);
+
+/**
+ * @brief Insert byte string
+ *
+ * @param cf
+ * @param key
+ * @param len
+ * @return int 0 on success, -1 if the filter is full
+ **/
+int cuckoo_insert(cuckoo_filter_t* cf, const void* key, size_t len);
+
+/**
+ * @brief Test byte string
+ *
+ * @param cf
+ * @param key
+ * @param len
+ * @return int 1 if possibly present, 0 if absent
+ **/
+int cuckoo_contains(const cuckoo_filter_t* cf, const void* key, size_t len);
+
+/**
+ * @brief Remove byte string
+ *
+ * @param cf
+ * @param key
+ * @param len
+ * @return int 1 if removed, 0 if not found
+ **/
+int cuckoo_remove(cuckoo_filter_t* cf, const void* key, size_t len);
+
+/**
+ * @brief Fraction of occupied slots
+ *
+ * @param cf
+ * @return double
+ **/
+double cuckoo_load(const cuckoo_filter_t* cf);
+
+/**
+ * @brief Memory used by the filter in bytes
+ *
+ * @param cf
+ * @return size_t
+ **/
+size_t cuckoo_memory(const cuckoo_filter_t* cf);
+
+#endif    // CUCKOO_H
@@ -1,8 +1,15 @@
+#include "fib_algos.h"
+
 #include <float.h>
+#include <immintrin.h>
 #include <math.h>
 #include <stdint.h>
 
 #include "pow_algos.h"
+#include "simd_fmix.h"
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx512dq")))
 
 #define MAX_CACHE 94
 
@@ -138,3 +145,79 @@ float fib_golden_ratio_binary(float miles) {
 
     return Fk1 + ((miles - Fk) * ((float)(Fk2 - Fk1) / (Fk1 - Fk)));
 }
+
+AVX512_TARGET static size_t fib_hash_bulk32_avx512(
+    const uint32_t* keys, uint32_t* out, size_t n, unsigned bits) {
+    const __m512i mul = _mm512_set1_epi32((int)FIB_HASH_MUL32);
+    const __m128i shift = _mm_cvtsi32_si128((int)(32 - bits));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512i k = _mm512_loadu_si512((const void*)(keys + i));
+        _mm512_storeu_si512((void*)(out + i), _mm512_srl_epi32(_mm512_mullo_epi32(k, mul), shift));
+    }
+    return i;
+}
+
+AVX2_TARGET static size_t fib_hash_bulk32_avx2(const uint32_t* keys, uint32_t* out, size_t n, unsigned bits) {
+    const __m256i mul = _mm256_set1_epi32((int)FIB_HASH_MUL32);
+    const __m128i shift = _mm_cvtsi32_si128((int)(32 - bits));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i k = _mm256_loadu_si256((const __m256i*)(keys + i));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_srl_epi32(_mm256_mullo_epi32(k, mul), shift));
+    }
+    return i;
+}
+
+void fib_hash_bulk32(const uint32_t* keys, uint32_t* out, size_t n, unsigned bits) {
+    size_t i = 0;
+
+    if (__builtin_cpu_supports("avx512f")) {
+        i = fib_hash_bulk32_avx512(keys, out, n, bits);
+    } else if (__builtin_cpu_supports("avx2")) {
+        i = fib_hash_bulk32_avx2(keys, out, n, bits);
+    }
+    for (; i < n; i++) {
+        out[i] = fib_hash32(keys[i], bits);
+    }
+}
+
+AVX512_TARGET static size_t fib_hash_bulk64_avx512(
+    const uint64_t* keys, uint64_t* out, size_t n, unsigned bits) {
+    const __m512i mul = _mm512_set1_epi64((long long)FIB_HASH_MUL64);
+    const __m128i shift = _mm_cvtsi32_si128((int)(64 - bits));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512i k = _mm512_loadu_si512((const void*)(keys + i));
+        _mm512_storeu_si512((void*)(out + i), _mm512_srl_epi64(_mm512_mullo_epi64(k, mul), shift));
+    }
+    return i;
+}
+
+AVX2_TARGET static size_t fib_hash_bulk64_avx2(const uint64_t* keys, uint64_t* out, size_t n, unsigned bits) {
+    const __m256i mul = _mm256_set1_epi64x((long long)FIB_HASH_MUL64);
+    const __m128i shift = _mm_cvtsi32_si128((int)(64 - bits));
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256i k = _mm256_loadu_si256((const __m256i*)(keys + i));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_srl_epi64(mul64_avx2(k, mul), shift));
+    }
+    return i;
+}
+
+void fib_hash_bulk64(const uint64_t* keys, uint64_t* out, size_t n, unsigned bits) {
+    size_t i = 0;
+
+    if (__builtin_cpu_supports("avx512dq")) {
+        i = fib_hash_bulk64_avx512(keys, out, n, bits);
+    } else if (__builtin_cpu_supports("avx2")) {
+        i = fib_hash_bulk64_avx2(keys, out, n, bits);
+    }
+    for (; i < n; i++) {
+        out[i] = fib_hash64(keys[i], bits);
+    }
+}
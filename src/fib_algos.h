@@ -1,8 +1,13 @@
 #ifndef FIB_ALGORITHMS_H
 #define FIB_ALGORITHMS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
+// 2^32 / phi and 2^64 / phi, rounded to odd
+#define FIB_HASH_MUL32 0x9E3779B9u
+#define FIB_HASH_MUL64 0x9E3779B97F4A7C15ULL
+
 // Basic implementations
 uint64_t fibonacci(int num);
 
@@ -46,4 +51,49 @@ float fib_golden_ratio(float miles);
  **/
 float fib_golden_ratio_binary(float miles);
 
+/**
+ * @brief Fibonacci hashing: bucket of 32-bit key in a table of 2^bits buckets
+ *
+ * The product keeps the top bits, which depend on every key bit, so keys that differ only in
+ * high bits (strides, aligned pointers) still spread, unlike masking.
+ *
+ * @param key
+ * @param bits 1..32
+ * @return uint32_t index in [0, 2^bits)
+ **/
+static inline uint32_t fib_hash32(uint32_t key, unsigned bits) {
+    return (key * FIB_HASH_MUL32) >> (32 - bits);
+}
+
+/**
+ * @brief Fibonacci hashing: bucket of 64-bit key in a table of 2^bits buckets
+ *
+ * @param key
+ * @param bits 1..64
+ * @return uint64_t index in [0, 2^bits)
+ **/
+static inline uint64_t fib_hash64(uint64_t key, unsigned bits) {
+    return (key * FIB_HASH_MUL64) >> (64 - bits);
+}
+
+/**
+ * @brief fib_hash32 over an array (AVX-512 or AVX2 if supported)
+ *
+ * @param keys
+ * @param out n indexes
+ * @param n
+ * @param bits 1..32
+ **/
+void fib_hash_bulk32(const uint32_t* keys, uint32_t* out, size_t n, unsigned bits);
+
+/**
+ * @brief fib_hash64 over an array (AVX-512 or AVX2 if supported)
+ *
+ * @param keys
+ * @param out n indexes
+ * @param n
+ * @param bits 1..64
+ **/
+void fib_hash_bulk64(const uint64_t* keys, uint64_t* out, size_t n, unsigned bits);
+
 #endif
@@ -0,0 +1,380 @@
+#include "hyperloglog.h"
+
+#include <immintrin.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "algos.h"
+#include "simd_fmix.h"
+
+#define HLL_RANK_BITS 6
+#define HLL_RANK_MASK ((1u << HLL_RANK_BITS) - 1)
+#define HLL_SPARSE_INITIAL_CAP 64
+// entries prepared per SIMD round in the batch paths
+#define HLL_BATCH 256
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx512dq,avx512cd")))
+
+// sparse entry: 25-bit index, then the rank relative to the dense precision
+static inline uint32_t hll_entry(uint64_t hash, int precision) {
+    uint32_t rank = (uint32_t)__builtin_clzll((hash << precision) | (1ULL << (precision - 1))) + 1;
+    return (uint32_t)(hash >> (64 - HLL_SPARSE_PRECISION)) << HLL_RANK_BITS | rank;
+}
+
+static inline void hll_dense_update(uint8_t* registers, int precision, uint32_t entry) {
+    uint32_t index = entry >> (HLL_RANK_BITS + HLL_SPARSE_PRECISION - precision);
+    uint8_t rank = (uint8_t)(entry & HLL_RANK_MASK);
+
+    if (registers[index] < rank) {
+        registers[index] = rank;
+    }
+}
+
+// sparse entries above this count take more memory than the dense registers
+static inline size_t hll_sparse_limit(int precision) {
+    return ((size_t)1 << precision) / sizeof(uint32_t);
+}
+
+int hll_init(hll_t* hll, int precision) {
+    memset(hll, 0, sizeof(*hll));
+    if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+        return -1;
+    }
+
+    size_t limit = hll_sparse_limit(precision);
+    hll->precision = precision;
+    hll->sparse_cap = limit < HLL_SPARSE_INITIAL_CAP ? limit : HLL_SPARSE_INITIAL_CAP;
+    hll->sparse = malloc(hll->sparse_cap * sizeof(uint32_t));
+    return hll->sparse ? 0 : -1;
+}
+
+void hll_free(hll_t* hll) {
+    free(hll->registers);
+    free(hll->sparse);
+    memset(hll, 0, sizeof(*hll));
+}
+
+static int hll_compare_entries(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// sort and keep one entry (the highest rank) per index
+static size_t hll_sort_unique(uint32_t* entries, size_t len) {
+    size_t out = 0;
+
+    qsort(entries, len, sizeof(uint32_t), hll_compare_entries);
+    for (size_t i = 0; i < len; i++) {
+        if (out > 0 && entries[out - 1] >> HLL_RANK_BITS == entries[i] >> HLL_RANK_BITS) {
+            out--;
+        }
+        entries[out++] = entries[i];
+    }
+    return out;
+}
+
+static void hll_compact(hll_t* hll) {
+    if (hll->sparse_sorted != hll->sparse_len) {
+        hll->sparse_len = hll_sort_unique(hll->sparse, hll->sparse_len);
+        hll->sparse_sorted = hll->sparse_len;
+    }
+}
+
+static int hll_to_dense(hll_t* hll) {
+    hll->registers = calloc((size_t)1 << hll->precision, 1);
+    if (!hll->registers) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < hll->sparse_len; i++) {
+        hll_dense_update(hll->registers, hll->precision, hll->sparse[i]);
+    }
+    free(hll->sparse);
+    hll->sparse = NULL;
+    hll->sparse_len = 0;
+    hll->sparse_sorted = 0;
+    hll->sparse_cap = 0;
+    return 0;
+}
+
+static int hll_sparse_insert(hll_t* hll, uint32_t entry) {
+    if (hll->sparse_len == hll->sparse_cap) {
+        hll_compact(hll);
+
+        // still more than half full: grow, or go dense once the list outweighs the registers
+        if (hll->sparse_len > hll->sparse_cap / 2) {
+            size_t cap = hll->sparse_cap * 2;
+            if (cap > hll_sparse_limit(hll->precision)) {
+                if (hll_to_dense(hll) < 0) {
+                    return -1;
+                }
+                hll_dense_update(hll->registers, hll->precision, entry);
+                return 0;
+            }
+
+            uint32_t* sparse = realloc(hll->sparse, cap * sizeof(uint32_t));
+            if (!sparse) {
+                return -1;
+            }
+            hll->sparse = sparse;
+            hll->sparse_cap = cap;
+        }
+    }
+
+    hll->sparse[hll->sparse_len++] = entry;
+    return 0;
+}
+
+static int hll_add_entry(hll_t* hll, uint32_t entry) {
+    if (hll->registers) {
+        hll_dense_update(hll->registers, hll->precision, entry);
+        return 0;
+    }
+    return hll_sparse_insert(hll, entry);
+}
+
+int hll_add_hash(hll_t* hll, uint64_t hash) {
+    return hll_add_entry(hll, hll_entry(hash, hll->precision));
+}
+
+int hll_add(hll_t* hll, const void* data, size_t len) {
+    return hll_add_hash(hll, murmur3_x64_64(data, len, 0));
+}
+
+static void hll_entries_scalar(const uint64_t* in, size_t n, int mix, int precision, uint32_t* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = hll_entry(mix ? fmix64(in[i]) : in[i], precision);
+    }
+}
+
+AVX512_TARGET static void hll_entries_avx512(
+    const uint64_t* in, size_t n, int mix, int precision, uint32_t* out) {
+    const __m512i guard = _mm512_set1_epi64((long long)(1ULL << (precision - 1)));
+    const __m512i one = _mm512_set1_epi64(1);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512i h = _mm512_loadu_si512(in + i);
+        if (mix) {
+            h = fmix64_avx512(h);
+        }
+        __m512i w = _mm512_or_si512(_mm512_slli_epi64(h, (unsigned)precision), guard);
+        __m512i rank = _mm512_add_epi64(_mm512_lzcnt_epi64(w), one);
+        __m512i index = _mm512_slli_epi64(_mm512_srli_epi64(h, 64 - HLL_SPARSE_PRECISION), HLL_RANK_BITS);
+        _mm256_storeu_si256((__m256i*)(out + i), _mm512_cvtepi64_epi32(_mm512_or_si512(index, rank)));
+    }
+    hll_entries_scalar(in + i, n - i, mix, precision, out + i);
+}
+
+static int hll_add_batch(hll_t* hll, const uint64_t* in, size_t n, int mix) {
+    int simd = __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512cd");
+    uint32_t entries[HLL_BATCH];
+
+    for (size_t pos = 0; pos < n; pos += HLL_BATCH) {
+        size_t len = n - pos < HLL_BATCH ? n - pos : HLL_BATCH;
+
+        if (simd) {
+            hll_entries_avx512(in + pos, len, mix, hll->precision, entries);
+        } else {
+            hll_entries_scalar(in + pos, len, mix, hll->precision, entries);
+        }
+
+        size_t i = 0;
+        while (i < len && !hll->registers) {
+            if (hll_sparse_insert(hll, entries[i++]) < 0) {
+                return -1;
+            }
+        }
+        for (; i < len; i++) {
+            hll_dense_update(hll->registers, hll->precision, entries[i]);
+        }
+    }
+    return 0;
+}
+
+int hll_add_hash_batch(hll_t* hll, const uint64_t* hashes, size_t n) {
+    return hll_add_batch(hll, hashes, n, 0);
+}
+
+int hll_add_u64_batch(hll_t* hll, const uint64_t* items, size_t n) {
+    return hll_add_batch(hll, items, n, 1);
+}
+
+// sigma and tau from Ertl, "New cardinality estimation algorithms for HyperLogLog sketches"
+static double hll_sigma(double x) {
+    double y = 1.0;
+    double z = x;
+    double prev;
+
+    do {
+        x *= x;
+        prev = z;
+        z += x * y;
+        y += y;
+    } while (z != prev);
+    return z;
+}
+
+static double hll_tau(double x) {
+    double y = 1.0;
+    double z = 1.0 - x;
+    double prev;
+
+    if (x == 0.0 || x == 1.0) {
+        return 0.0;
+    }
+    do {
+        x = sqrt(x);
+        prev = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+    } while (z != prev);
+    return z / 3.0;
+}
+
+static double hll_estimate_dense(const uint8_t* registers, int precision) {
+    int q = 64 - precision;
+    double m = (double)((size_t)1 << precision);
+    size_t histogram[66] = { 0 };
+
+    for (size_t i = 0; i < ((size_t)1 << precision); i++) {
+        histogram[registers[i]]++;
+    }
+
+    // all registers empty, sigma(1) diverges
+    if (histogram[0] == ((size_t)1 << precision)) {
+        return 0.0;
+    }
+
+    double z = m * hll_tau(1.0 - histogram[q + 1] / m);
+    for (int k = q; k >= 1; k--) {
+        z = 0.5 * (z + histogram[k]);
+    }
+    z += m * hll_sigma(histogram[0] / m);
+    return m * m / (2.0 * log(2.0)) / z;
+}
+
+// linear counting over the 2^25 sparse indexes
+static double hll_estimate_sparse(size_t distinct) {
+    double m = (double)(1u << HLL_SPARSE_PRECISION);
+    return m * log(m / (m - (double)distinct));
+}
+
+double hll_estimate(hll_t* hll) {
+    if (hll->registers) {
+        return hll_estimate_dense(hll->registers, hll->precision);
+    }
+    hll_compact(hll);
+    return hll_estimate_sparse(hll->sparse_len);
+}
+
+AVX2_TARGET static void hll_max_avx2(uint8_t* dst, const uint8_t* src, size_t n) {
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_max_epu8(a, b));
+    }
+    for (; i < n; i++) {
+        dst[i] = dst[i] > src[i] ? dst[i] : src[i];
+    }
+}
+
+static void hll_max_registers(uint8_t* dst, const uint8_t* src, size_t n) {
+    if (__builtin_cpu_supports("avx2")) {
+        hll_max_avx2(dst, src, n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = dst[i] > src[i] ? dst[i] : src[i];
+    }
+}
+
+static void hll_union_into(uint8_t* registers, const hll_t* src) {
+    if (src->registers) {
+        hll_max_registers(registers, src->registers, (size_t)1 << src->precision);
+        return;
+    }
+    for (size_t i = 0; i < src->sparse_len; i++) {
+        hll_dense_update(registers, src->precision, src->sparse[i]);
+    }
+}
+
+int hll_merge(hll_t* dst, const hll_t* src) {
+    if (dst->precision != src->precision) {
+        return -1;
+    }
+
+    if (!dst->registers && !src->registers) {
+        for (size_t i = 0; i < src->sparse_len; i++) {
+            if (hll_add_entry(dst, src->sparse[i]) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    if (!dst->registers && hll_to_dense(dst) < 0) {
+        return -1;
+    }
+    hll_union_into(dst->registers, src);
+    return 0;
+}
+
+double hll_estimate_merged(const hll_t* sketches, size_t count) {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    int precision = sketches[0].precision;
+    size_t sparse_total = 0;
+    int all_sparse = 1;
+    for (size_t i = 0; i < count; i++) {
+        if (sketches[i].precision != precision) {
+            return -1.0;
+        }
+        all_sparse &= sketches[i].registers == NULL;
+        sparse_total += sketches[i].sparse_len;
+    }
+
+    // small unions stay exact on the 25-bit indexes
+    if (all_sparse) {
+        uint32_t* entries = malloc((sparse_total ? sparse_total : 1) * sizeof(uint32_t));
+        if (!entries) {
+            return -1.0;
+        }
+
+        size_t len = 0;
+        for (size_t i = 0; i < count; i++) {
+            memcpy(entries + len, sketches[i].sparse, sketches[i].sparse_len * sizeof(uint32_t));
+            len += sketches[i].sparse_len;
+        }
+        double estimate = hll_estimate_sparse(hll_sort_unique(entries, len));
+        free(entries);
+        return estimate;
+    }
+
+    uint8_t* registers = calloc((size_t)1 << precision, 1);
+    if (!registers) {
+        return -1.0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        hll_union_into(registers, &sketches[i]);
+    }
+
+    double estimate = hll_estimate_dense(registers, precision);
+    free(registers);
+    return estimate;
+}
+
+size_t hll_memory(const hll_t* hll) {
+    if (hll->registers) {
+        return (size_t)1 << hll->precision;
+    }
+    return hll->sparse_cap * sizeof(uint32_t);
+}
@@ -0,0 +1,123 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HLL_MIN_PRECISION 4
+#define HLL_MAX_PRECISION 18
+// index bits kept by the sparse representation, far more than any dense precision
+#define HLL_SPARSE_PRECISION 25
+
+/**
+ * @brief HyperLogLog cardinality sketch
+ *
+ * Starts sparse (sorted list of (25-bit index, rank) entries) and switches to
+ * 2^precision one-byte registers once the list would take more memory.
+ *
+ * @param registers dense registers, NULL while sparse
+ * @param sparse sparse entries, the first sparse_sorted are sorted and unique
+ * @param sparse_len number of sparse entries
+ * @param sparse_sorted sorted prefix length
+ * @param sparse_cap sparse capacity
+ * @param precision log2 of the number of dense registers
+ **/
+typedef struct {
+    uint8_t* registers;
+    uint32_t* sparse;
+    size_t sparse_len;
+    size_t sparse_sorted;
+    size_t sparse_cap;
+    int precision;
+} hll_t;
+
+/**
+ * @brief Initialize empty sketch (sparse)
+ *
+ * @param hll
+ * @param precision HLL_MIN_PRECISION..HLL_MAX_PRECISION, standard error is 1.04 / sqrt(2^precision)
+ * @return int 0 on success, -1 on invalid precision or allocation error
+ **/
+int hll_init(hll_t* hll, int precision);
+
+/**
+ * @brief Free sketch
+ *
+ * @param hll
+ **/
+void hll_free(hll_t* hll);
+
+/**
+ * @brief Add 64-bit hash
+ *
+ * @param hll
+ * @param hash
+ * @return int 0 on success, -1 on allocation error
+ **/
+int hll_add_hash(hll_t* hll, uint64_t hash);
+
+/**
+ * @brief Add byte string (hashed with murmur3_x64_64)
+ *
+ * @param hll
+ * @param data
+ * @param len
+ * @return int 0 on success, -1 on allocation error
+ **/
+int hll_add(hll_t* hll, const void* data, size_t len);
+
+/**
+ * @brief Add many 64-bit hashes, ranks are computed in SIMD lanes (AVX-512 if supported)
+ *
+ * @param hll
+ * @param hashes
+ * @param n
+ * @return int 0 on success, -1 on allocation error
+ **/
+int hll_add_hash_batch(hll_t* hll, const uint64_t* hashes, size_t n);
+
+/**
+ * @brief Add many integers (hashed with fmix64), hashes and ranks are computed in SIMD lanes
+ *
+ * @param hll
+ * @param items
+ * @param n
+ * @return int 0 on success, -1 on allocation error
+ **/
+int hll_add_u64_batch(hll_t* hll, const uint64_t* items, size_t n);
+
+/**
+ * @brief Estimate number of distinct items (compacts the sparse list)
+ *
+ * @param hll
+ * @return double
+ **/
+double hll_estimate(hll_t* hll);
+
+/**
+ * @brief Merge src into dst (union of the streams)
+ *
+ * @param dst
+ * @param src same precision as dst
+ * @return int 0 on success, -1 on precision mismatch or allocation error
+ **/
+int hll_merge(hll_t* dst, const hll_t* src);
+
+/**
+ * @brief Estimate union of several sketches without modifying them (e.g. one sketch per thread)
+ *
+ * @param sketches
+ * @param count
+ * @return double estimate, negative on precision mismatch or allocation error
+ **/
+double hll_estimate_merged(const hll_t* sketches, size_t count);
+
+/**
+ * @brief Memory used by the sketch in bytes
+ *
+ * @param hll
+ * @return size_t
+ **/
+size_t hll_memory(const hll_t* hll);
+
+#endif    // HYPERLOGLOG_H
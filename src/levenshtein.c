@@ -1,15 +1,18 @@
+#include "levenshtein.h"
+
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-int min2(int a, int b) {
+static int min2(int a, int b) {
     return a < b ? a : b;
 }
 
-int min3(int a, int b, int c) {
+static int min3(int a, int b, int c) {
     return min2(a, min2(b, c));
 }
 
-int levenshtein(const char* s1, const char* s2) {
+int levenshtein_dp(const char* s1, const char* s2) {
     int n = strlen(s1);
     int m = strlen(s2);
 
@@ -31,6 +34,11 @@ int levenshtein(const char* s1, const char* s2) {
 
     int* prev = (int*)malloc((n + 1) * sizeof(int));
     int* curr = (int*)malloc((n + 1) * sizeof(int));
+    if (!prev || !curr) {
+        free(prev);
+        free(curr);
+        return -1;
+    }
 
     for (int i = 0; i <= n; i++) {
         prev[i] = i;
@@ -56,3 +64,102 @@ int levenshtein(const char* s1, const char* s2) {
 
     return result;
 }
+
+// one column of one 64-row block: pv/mv are the vertical +1/-1 deltas, hin the horizontal delta
+// entering the block's first row (the top row of the matrix always adds 1), returns the delta
+// leaving the row marked by last
+static inline int levenshtein_advance(uint64_t* pv, uint64_t* mv, uint64_t eq, int hin, uint64_t last) {
+    uint64_t p = *pv;
+    uint64_t m = *mv;
+
+    if (hin < 0) {
+        eq |= 1;
+    }
+    uint64_t xv = eq | m;
+    uint64_t xh = (((eq & p) + p) ^ p) | eq;
+    uint64_t ph = m | ~(xh | p);
+    uint64_t mh = p & xh;
+    int hout = (ph & last) ? 1 : (mh & last) ? -1 : 0;
+
+    ph <<= 1;
+    mh <<= 1;
+    if (hin < 0) {
+        mh |= 1;
+    } else if (hin > 0) {
+        ph |= 1;
+    }
+    *pv = mh | ~(xv | ph);
+    *mv = ph & xv;
+    return hout;
+}
+
+static int levenshtein_word(const uint8_t* a, size_t n, const uint8_t* b, size_t m) {
+    uint64_t peq[256];
+    uint64_t pv = ~0ULL;
+    uint64_t mv = 0;
+    uint64_t last = 1ULL << (n - 1);
+    int score = (int)n;
+
+    memset(peq, 0, sizeof(peq));
+    for (size_t i = 0; i < n; i++) {
+        peq[a[i]] |= 1ULL << i;
+    }
+    for (size_t j = 0; j < m; j++) {
+        score += levenshtein_advance(&pv, &mv, peq[b[j]], 1, last);
+    }
+    return score;
+}
+
+// rows past n in the last block see no matches, they sit below the last row and never reach it
+static int levenshtein_blocks(const uint8_t* a, size_t n, const uint8_t* b, size_t m) {
+    size_t words = (n + LEVENSHTEIN_WORD_BITS - 1) / LEVENSHTEIN_WORD_BITS;
+    uint64_t* peq = calloc(256 * words + 2 * words, sizeof(uint64_t));
+    if (!peq) {
+        return -1;
+    }
+
+    uint64_t* pv = peq + 256 * words;
+    uint64_t* mv = pv + words;
+    uint64_t last = 1ULL << ((n - 1) % LEVENSHTEIN_WORD_BITS);
+    int score = (int)n;
+
+    for (size_t i = 0; i < n; i++) {
+        peq[a[i] * words + i / LEVENSHTEIN_WORD_BITS] |= 1ULL << (i % LEVENSHTEIN_WORD_BITS);
+    }
+    memset(pv, 0xff, words * sizeof(uint64_t));
+
+    for (size_t j = 0; j < m; j++) {
+        const uint64_t* eq = peq + b[j] * words;
+        int h = 1;
+        for (size_t w = 0; w + 1 < words; w++) {
+            h = levenshtein_advance(&pv[w], &mv[w], eq[w], h, 1ULL << 63);
+        }
+        score += levenshtein_advance(&pv[words - 1], &mv[words - 1], eq[words - 1], h, last);
+    }
+
+    free(peq);
+    return score;
+}
+
+int levenshtein_bytes(const uint8_t* a, size_t n, const uint8_t* b, size_t m) {
+    if (n > m) {
+        const uint8_t* tmp = a;
+        a = b;
+        b = tmp;
+        size_t t = n;
+        n = m;
+        m = t;
+    }
+
+    if (n == 0) {
+        return (int)m;
+    }
+    if (n <= LEVENSHTEIN_WORD_BITS) {
+        return levenshtein_word(a, n, b, m);
+    }
+    return levenshtein_blocks(a, n, b, m);
+}
+
+int levenshtein(const char* s1, const char* s2) {
+    return levenshtein_bytes((const uint8_t*)s1, strlen(s1), (const uint8_t*)s2, strlen(s2));
+}
@@ -1,5 +1,46 @@
 #ifndef LEVENSHTEIN_H
+#define LEVENSHTEIN_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+// patterns up to this length fit one machine word of the bit-parallel algorithm
+#define LEVENSHTEIN_WORD_BITS 64
+
+/**
+ * @brief Edit distance (insertions, deletions, substitutions) of two strings
+ *
+ * Uses levenshtein_bytes.
+ *
+ * @param s1
+ * @param s2
+ * @return int distance, -1 on allocation error
+ **/
 int levenshtein(const char* s1, const char* s2);
 
+/**
+ * @brief Reference edit distance: row-by-row dynamic programming, O(n * m)
+ *
+ * @param s1
+ * @param s2
+ * @return int distance, -1 on allocation error
+ **/
+int levenshtein_dp(const char* s1, const char* s2);
+
+/**
+ * @brief Bit-parallel edit distance (Myers 1999, Hyyrö 2003), O(ceil(n / 64) * m)
+ *
+ * The shorter input is the pattern: each of its positions is one bit of the vertical delta vectors,
+ * so one column of the DP matrix costs a handful of word operations. Patterns up to
+ * LEVENSHTEIN_WORD_BITS bytes use a single word and no allocation, longer ones are split into
+ * 64-bit blocks that pass the horizontal delta of their last row to the next block.
+ *
+ * @param a
+ * @param n
+ * @param b
+ * @param m
+ * @return int distance, -1 on allocation error
+ **/
+int levenshtein_bytes(const uint8_t* a, size_t n, const uint8_t* b, size_t m);
+
 #endif    // LEVENSHTEIN_H
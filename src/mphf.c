@@ -0,0 +1,550 @@
+#include "mphf.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "algos.h"
+#include "threadpool.h"
+
+// keys hashed per parallel task
+#define MPHF_HASH_BLOCK 65536
+// global seeds tried before duplicate 64-bit hashes are reported as duplicate keys
+#define MPHF_MAX_ATTEMPTS 4
+// partition seeds tried before a partition gives up (pilots are 16-bit)
+#define MPHF_PARTITION_ATTEMPTS 16
+#define MPHF_MAX_PILOT 0xffffu
+
+#define MPHF_PILOT_MUL 0x9e3779b97f4a7c15ULL
+#define MPHF_SEED_MUL 0xbf58476d1ce4e5b9ULL
+// 60% of the keys go to the first 30% of the buckets, see mphf_bucket
+#define MPHF_DENSE_KEYS 0x9999999aULL
+#define MPHF_DENSE_BUCKETS_PERCENT 30
+
+enum { MPHF_OK, MPHF_ERR_DUPLICATE, MPHF_ERR_NOMEM, MPHF_ERR_PILOT };
+
+typedef struct {
+    const void* const* keys;
+    const size_t* lens;
+    const uint64_t* ints;
+    size_t n;
+    uint32_t seed;
+    uint64_t* hashes;
+} mphf_hash_job_t;
+
+typedef struct {
+    const uint64_t* hashes;
+    mphf_partition_t* partitions;
+    uint16_t* pilots;
+    uint16_t* remap;
+    int status;
+} mphf_build_job_t;
+
+static inline uint64_t mphf_fastrange(uint64_t x, uint64_t n) {
+    return (uint64_t)(((unsigned __int128)x * n) >> 64);
+}
+
+static inline size_t mphf_align8(size_t x) {
+    return (x + 7) & ~(size_t)7;
+}
+
+static inline uint64_t mphf_mix(uint64_t hash, uint32_t seed) {
+    return fmix64(hash ^ (seed * MPHF_SEED_MUL));
+}
+
+// skewed bucket assignment: dense buckets fill first while the table is empty
+static inline uint32_t mphf_bucket(uint64_t x, uint32_t nbuckets) {
+    uint32_t dense = nbuckets * MPHF_DENSE_BUCKETS_PERCENT / 100;
+    uint64_t hi = x >> 32;
+
+    if ((x & 0xffffffffu) < MPHF_DENSE_KEYS) {
+        return (uint32_t)((hi * dense) >> 32);
+    }
+    return dense + (uint32_t)((hi * (nbuckets - dense)) >> 32);
+}
+
+static inline uint32_t mphf_position(uint64_t x, uint32_t pilot, uint32_t table_size) {
+    return (uint32_t)mphf_fastrange(fmix64(x ^ (pilot * MPHF_PILOT_MUL)), table_size);
+}
+
+uint64_t mphf_hash_key(const void* key, size_t len, uint32_t seed) {
+    uint64_t hi = jenkins_hash(key, len, seed);
+    uint64_t lo = jenkins_hash(key, len, seed ^ 0x5bd1e995u);
+    return fmix64(hi << 32 | lo);
+}
+
+uint64_t mphf_hash_u64(uint64_t key, uint32_t seed) {
+    // fmix64 is a bijection, distinct keys never share a hash
+    return fmix64(key ^ (seed * MPHF_PILOT_MUL));
+}
+
+uint64_t mphf_lookup_hash(const mphf_t* mphf, uint64_t hash) {
+    const mphf_partition_t* part = &mphf->partitions[mphf_fastrange(hash, mphf->header->npartitions)];
+
+    // only keys outside the set reach a partition without keys, any index in range will do
+    if (part->nkeys == 0) {
+        return mphf->header->nkeys ? part->key_offset % mphf->header->nkeys : 0;
+    }
+
+    uint64_t x = mphf_mix(hash, part->seed);
+    uint16_t pilot = mphf->pilots[part->pilot_offset + mphf_bucket(x, part->nbuckets)];
+    uint32_t pos = mphf_position(x, pilot, part->table_size);
+
+    if (pos < part->nkeys) {
+        return part->key_offset + pos;
+    }
+    return part->key_offset + mphf->remap[part->remap_offset + pos - part->nkeys];
+}
+
+uint64_t mphf_lookup(const mphf_t* mphf, const void* key, size_t len) {
+    return mphf_lookup_hash(mphf, mphf_hash_key(key, len, mphf->header->seed));
+}
+
+uint64_t mphf_lookup_u64(const mphf_t* mphf, uint64_t key) {
+    return mphf_lookup_hash(mphf, mphf_hash_u64(key, mphf->header->seed));
+}
+
+uint64_t mphf_size(const mphf_t* mphf) {
+    return mphf->header->nkeys;
+}
+
+static void mphf_hash_task(void* ctx, size_t task) {
+    mphf_hash_job_t* job = (mphf_hash_job_t*)ctx;
+    size_t first = task * MPHF_HASH_BLOCK;
+    size_t last = job->n - first < MPHF_HASH_BLOCK ? job->n : first + MPHF_HASH_BLOCK;
+
+    for (size_t i = first; i < last; i++) {
+        job->hashes[i] = job->keys ? mphf_hash_key(job->keys[i], job->lens[i], job->seed)
+                                   : mphf_hash_u64(job->ints[i], job->seed);
+    }
+}
+
+// place every bucket of one partition, biggest buckets first
+static int mphf_place_partition(
+    const mphf_partition_t* part,
+    const uint64_t* hashes,
+    uint64_t* xs,
+    uint32_t* bucket_start,
+    uint32_t* order,
+    uint64_t* taken,
+    uint16_t* pilots,
+    uint16_t* remap) {
+    uint32_t nk = part->nkeys;
+    uint32_t nb = part->nbuckets;
+    uint32_t max_size = 0;
+    uint32_t positions[256];
+
+    // counting sort of the keys by bucket
+    memset(bucket_start, 0, (nb + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < nk; i++) {
+        bucket_start[mphf_bucket(mphf_mix(hashes[i], part->seed), nb) + 1]++;
+    }
+    for (uint32_t b = 0; b < nb; b++) {
+        uint32_t size = bucket_start[b + 1];
+        max_size = size > max_size ? size : max_size;
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    if (max_size > sizeof(positions) / sizeof(positions[0])) {
+        return MPHF_ERR_PILOT;
+    }
+    for (uint32_t i = 0; i < nk; i++) {
+        uint64_t x = mphf_mix(hashes[i], part->seed);
+        xs[bucket_start[mphf_bucket(x, nb)]++] = x;
+    }
+    for (uint32_t b = nb; b > 0; b--) {
+        bucket_start[b] = bucket_start[b - 1];
+    }
+    bucket_start[0] = 0;
+
+    // counting sort of the buckets by size, descending
+    uint32_t size_count[257] = { 0 };
+    for (uint32_t b = 0; b < nb; b++) {
+        size_count[max_size - (bucket_start[b + 1] - bucket_start[b]) + 1]++;
+    }
+    for (uint32_t s = 0; s < max_size; s++) {
+        size_count[s + 1] += size_count[s];
+    }
+    for (uint32_t b = 0; b < nb; b++) {
+        order[size_count[max_size - (bucket_start[b + 1] - bucket_start[b])]++] = b;
+    }
+
+    memset(taken, 0, ((part->table_size + 63) / 64) * sizeof(uint64_t));
+    memset(pilots, 0, nb * sizeof(uint16_t));
+
+    for (uint32_t k = 0; k < nb; k++) {
+        uint32_t b = order[k];
+        const uint64_t* bx = xs + bucket_start[b];
+        uint32_t size = bucket_start[b + 1] - bucket_start[b];
+
+        if (size == 0) {
+            break;
+        }
+        for (uint32_t i = 1; i < size; i++) {
+            for (uint32_t j = 0; j < i; j++) {
+                if (bx[i] == bx[j]) {
+                    return MPHF_ERR_DUPLICATE;
+                }
+            }
+        }
+
+        uint32_t pilot = 0;
+        for (; pilot <= MPHF_MAX_PILOT; pilot++) {
+            uint32_t i = 0;
+            for (; i < size; i++) {
+                uint32_t pos = mphf_position(bx[i], pilot, part->table_size);
+                if (taken[pos / 64] >> (pos % 64) & 1) {
+                    break;
+                }
+                uint32_t j = 0;
+                while (j < i && positions[j] != pos) {
+                    j++;
+                }
+                if (j < i) {
+                    break;
+                }
+                positions[i] = pos;
+            }
+            if (i == size) {
+                break;
+            }
+        }
+        if (pilot > MPHF_MAX_PILOT) {
+            return MPHF_ERR_PILOT;
+        }
+
+        pilots[b] = (uint16_t)pilot;
+        for (uint32_t i = 0; i < size; i++) {
+            taken[positions[i] / 64] |= 1ULL << (positions[i] % 64);
+        }
+    }
+
+    // keys that landed past nkeys are sent to the free slots below it
+    uint32_t free_slot = 0;
+    for (uint32_t pos = nk; pos < part->table_size; pos++) {
+        remap[pos - nk] = 0;
+        if (taken[pos / 64] >> (pos % 64) & 1) {
+            while (taken[free_slot / 64] >> (free_slot % 64) & 1) {
+                free_slot++;
+            }
+            remap[pos - nk] = (uint16_t)free_slot++;
+        }
+    }
+    return MPHF_OK;
+}
+
+static void mphf_partition_task(void* ctx, size_t task) {
+    mphf_build_job_t* job = (mphf_build_job_t*)ctx;
+    mphf_partition_t* part = &job->partitions[task];
+    size_t nk = part->nkeys;
+    size_t nb = part->nbuckets;
+    size_t words = (part->table_size + 63) / 64;
+
+    if (__atomic_load_n(&job->status, __ATOMIC_RELAXED) != MPHF_OK) {
+        return;
+    }
+
+    uint64_t* xs = malloc((nk + words) * sizeof(uint64_t) + (2 * nb + 1) * sizeof(uint32_t));
+    if (!xs) {
+        __atomic_store_n(&job->status, MPHF_ERR_NOMEM, __ATOMIC_RELAXED);
+        return;
+    }
+    uint64_t* taken = xs + nk;
+    uint32_t* bucket_start = (uint32_t*)(taken + words);
+    uint32_t* order = bucket_start + nb + 1;
+
+    int status = MPHF_ERR_PILOT;
+    for (uint32_t attempt = 0; attempt < MPHF_PARTITION_ATTEMPTS && status == MPHF_ERR_PILOT; attempt++) {
+        part->seed = (uint32_t)fmix64(task * MPHF_PARTITION_ATTEMPTS + attempt + 1);
+        status = mphf_place_partition(
+            part,
+            job->hashes + part->key_offset,
+            xs,
+            bucket_start,
+            order,
+            taken,
+            job->pilots + part->pilot_offset,
+            job->remap + part->remap_offset);
+    }
+
+    free(xs);
+    if (status != MPHF_OK) {
+        __atomic_store_n(&job->status, status, __ATOMIC_RELAXED);
+    }
+}
+
+// every partition must index inside the key range, the pilots and the remap table, and its remap
+// entries must stay below its key count, so lookups never leave the buffer or [0, nkeys)
+static int mphf_partitions_valid(
+    const mphf_header_t* header, const mphf_partition_t* parts, const uint16_t* remap) {
+    for (uint64_t i = 0; i < header->npartitions; i++) {
+        const mphf_partition_t* part = &parts[i];
+        uint64_t nremap = (uint64_t)part->table_size - part->nkeys;
+
+        if (part->nbuckets == 0 || part->table_size < part->nkeys || part->table_size == 0
+            || part->key_offset > header->nkeys || part->nkeys > header->nkeys - part->key_offset
+            || part->pilot_offset > header->npilots || part->nbuckets > header->npilots - part->pilot_offset
+            || part->remap_offset > header->nremap || nremap > header->nremap - part->remap_offset) {
+            return 0;
+        }
+        for (uint64_t r = 0; part->nkeys && r < nremap; r++) {
+            if (remap[part->remap_offset + r] >= part->nkeys) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static mphf_t* mphf_init(void* base, size_t size) {
+    const mphf_header_t* header = (const mphf_header_t*)base;
+
+    if (size < sizeof(mphf_header_t) || header->magic != MPHF_MAGIC || header->version != MPHF_VERSION
+        || header->size > size || header->npartitions == 0) {
+        return NULL;
+    }
+
+    // counts are bounded by the buffer first, so the size arithmetic cannot overflow
+    if (header->npartitions > size / sizeof(mphf_partition_t) || header->npilots > size / sizeof(uint16_t)
+        || header->nremap > size / sizeof(uint16_t)) {
+        return NULL;
+    }
+    size_t parts_size = header->npartitions * sizeof(mphf_partition_t);
+    size_t pilots_size = mphf_align8(header->npilots * sizeof(uint16_t));
+    size_t remap_size = mphf_align8(header->nremap * sizeof(uint16_t));
+    if (sizeof(mphf_header_t) + parts_size + pilots_size + remap_size != header->size) {
+        return NULL;
+    }
+
+    uint8_t* p = (uint8_t*)base + sizeof(mphf_header_t);
+    const mphf_partition_t* parts = (const mphf_partition_t*)p;
+    const uint16_t* remap = (const uint16_t*)(p + parts_size + pilots_size);
+    if (!mphf_partitions_valid(header, parts, remap)) {
+        return NULL;
+    }
+
+    mphf_t* mphf = calloc(1, sizeof(mphf_t));
+    if (!mphf) {
+        return NULL;
+    }
+
+    mphf->header = header;
+    mphf->partitions = parts;
+    mphf->pilots = (const uint16_t*)(p + parts_size);
+    mphf->remap = remap;
+    mphf->base = base;
+    mphf->size = header->size;
+    return mphf;
+}
+
+static mphf_t* mphf_build_hashes(
+    const uint64_t* hashes, size_t n, uint32_t seed, unsigned nthreads, int* status) {
+    size_t npart = n / MPHF_PARTITION_KEYS + 1;
+    size_t* fill = calloc(npart + 1, sizeof(size_t));
+    uint64_t* sorted = malloc(n * sizeof(uint64_t));
+
+    *status = MPHF_ERR_NOMEM;
+    if (!fill || !sorted) {
+        free(fill);
+        free(sorted);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        fill[mphf_fastrange(hashes[i], npart) + 1]++;
+    }
+
+    size_t npilots = 0;
+    size_t nremap = 0;
+    mphf_partition_t* layout = malloc(npart * sizeof(mphf_partition_t));
+    if (!layout) {
+        free(fill);
+        free(sorted);
+        return NULL;
+    }
+    for (size_t p = 0; p < npart; p++) {
+        size_t nk = fill[p + 1];
+        if (nk > 0xffff) {
+            // a partition this large only happens with a broken hash, remap entries are 16-bit
+            *status = MPHF_ERR_PILOT;
+            free(layout);
+            free(fill);
+            free(sorted);
+            return NULL;
+        }
+
+        mphf_partition_t* part = &layout[p];
+        part->key_offset = fill[p];
+        part->nkeys = (uint32_t)nk;
+        part->nbuckets = (uint32_t)((nk + MPHF_BUCKET_KEYS - 1) / MPHF_BUCKET_KEYS);
+        part->nbuckets = part->nbuckets ? part->nbuckets : 1;
+        part->table_size = (uint32_t)((nk * 100 + MPHF_LOAD_PERCENT - 1) / MPHF_LOAD_PERCENT);
+        part->table_size = part->table_size ? part->table_size : 1;
+        part->pilot_offset = npilots;
+        part->remap_offset = nremap;
+        part->seed = 0;
+        npilots += part->nbuckets;
+        nremap += part->table_size - part->nkeys;
+        fill[p + 1] += fill[p];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        sorted[fill[mphf_fastrange(hashes[i], npart)]++] = hashes[i];
+    }
+    free(fill);
+
+    size_t parts_size = npart * sizeof(mphf_partition_t);
+    size_t pilots_size = mphf_align8(npilots * sizeof(uint16_t));
+    size_t remap_size = mphf_align8(nremap * sizeof(uint16_t));
+    size_t size = sizeof(mphf_header_t) + parts_size + pilots_size + remap_size;
+
+    uint8_t* base = calloc(1, size);
+    if (!base) {
+        free(layout);
+        free(sorted);
+        return NULL;
+    }
+
+    mphf_header_t* header = (mphf_header_t*)base;
+    header->magic = MPHF_MAGIC;
+    header->version = MPHF_VERSION;
+    header->seed = seed;
+    header->nkeys = n;
+    header->npartitions = npart;
+    header->npilots = npilots;
+    header->nremap = nremap;
+    header->size = size;
+
+    mphf_build_job_t job = {
+        .hashes = sorted,
+        .partitions = (mphf_partition_t*)(base + sizeof(mphf_header_t)),
+        .pilots = (uint16_t*)(base + sizeof(mphf_header_t) + parts_size),
+        .remap = (uint16_t*)(base + sizeof(mphf_header_t) + parts_size + pilots_size),
+        .status = MPHF_OK,
+    };
+    memcpy(job.partitions, layout, parts_size);
+    free(layout);
+
+    threadpool_run(npart, mphf_partition_task, &job, nthreads);
+    free(sorted);
+
+    *status = job.status;
+    mphf_t* mphf = job.status == MPHF_OK ? mphf_init(base, size) : NULL;
+    if (!mphf) {
+        free(base);
+        return NULL;
+    }
+    mphf->owned = 1;
+    return mphf;
+}
+
+static mphf_t* mphf_build_keys(
+    const void* const* keys, const size_t* lens, const uint64_t* ints, size_t n, unsigned nthreads) {
+    if (n == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    mphf_hash_job_t job = { .keys = keys, .lens = lens, .ints = ints, .n = n };
+    job.hashes = malloc(n * sizeof(uint64_t));
+    if (!job.hashes) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    mphf_t* mphf = NULL;
+    int status = MPHF_ERR_DUPLICATE;
+    for (uint32_t attempt = 0; attempt < MPHF_MAX_ATTEMPTS && !mphf; attempt++) {
+        job.seed = (uint32_t)fmix64(attempt + 0x9e3779b9u);
+        threadpool_run((n + MPHF_HASH_BLOCK - 1) / MPHF_HASH_BLOCK, mphf_hash_task, &job, nthreads);
+        mphf = mphf_build_hashes(job.hashes, n, job.seed, nthreads, &status);
+        if (status == MPHF_ERR_NOMEM) {
+            break;
+        }
+    }
+
+    free(job.hashes);
+    if (!mphf) {
+        errno = status == MPHF_ERR_NOMEM ? ENOMEM : EINVAL;
+    }
+    return mphf;
+}
+
+mphf_t* mphf_build(const void* const* keys, const size_t* lens, size_t n, unsigned nthreads) {
+    return mphf_build_keys(keys, lens, NULL, n, nthreads);
+}
+
+mphf_t* mphf_build_u64(const uint64_t* keys, size_t n, unsigned nthreads) {
+    return mphf_build_keys(NULL, NULL, keys, n, nthreads);
+}
+
+int mphf_save(const mphf_t* mphf, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return -1;
+    }
+
+    size_t written = fwrite(mphf->base, 1, mphf->size, file);
+    if (fclose(file) != 0 || written != mphf->size) {
+        return -1;
+    }
+    return 0;
+}
+
+mphf_t* mphf_load(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = size ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    int err = size ? errno : EINVAL;
+    close(fd);
+    if (map == MAP_FAILED) {
+        errno = err;
+        return NULL;
+    }
+
+    mphf_t* mphf = mphf_init(map, size);
+    if (!mphf) {
+        munmap(map, size);
+        errno = EINVAL;
+        return NULL;
+    }
+    mphf->size = size;
+    mphf->mapped = 1;
+    return mphf;
+}
+
+mphf_t* mphf_from_buffer(const void* data, size_t size) {
+    if ((uintptr_t)data & 7) {
+        return NULL;
+    }
+    return mphf_init((void*)data, size);
+}
+
+void mphf_free(mphf_t* mphf) {
+    if (!mphf) {
+        return;
+    }
+    if (mphf->mapped) {
+        munmap(mphf->base, mphf->size);
+    } else if (mphf->owned) {
+        free(mphf->base);
+    }
+    free(mphf);
+}
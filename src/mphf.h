@@ -0,0 +1,191 @@
+#ifndef MPHF_H
+#define MPHF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MPHF_MAGIC 0x4648504du    // "MPHF"
+#define MPHF_VERSION 1
+
+// average keys per partition, partitions are built independently on worker threads
+#define MPHF_PARTITION_KEYS 4096
+// average keys per bucket, each bucket stores one 16-bit pilot
+#define MPHF_BUCKET_KEYS 5
+// load factor of the per-partition table in percent, the rest is remapped
+#define MPHF_LOAD_PERCENT 97
+
+/**
+ * @brief Serialized header, followed by partitions, pilots and remap table
+ *
+ * @param magic MPHF_MAGIC
+ * @param version MPHF_VERSION
+ * @param seed key hash seed
+ * @param nkeys number of keys
+ * @param npartitions number of partitions
+ * @param npilots number of 16-bit pilots
+ * @param nremap number of 16-bit remap entries
+ * @param size total serialized size in bytes
+ **/
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seed;
+    uint32_t reserved;
+    uint64_t nkeys;
+    uint64_t npartitions;
+    uint64_t npilots;
+    uint64_t nremap;
+    uint64_t size;
+    uint64_t reserved2;
+} mphf_header_t;
+
+/**
+ * @brief Per-partition lookup parameters
+ *
+ * @param key_offset first index of the partition
+ * @param pilot_offset first pilot of the partition
+ * @param remap_offset first remap entry of the partition
+ * @param nkeys keys in the partition
+ * @param nbuckets buckets in the partition
+ * @param table_size slots in the partition table (>= nkeys)
+ * @param seed partition hash seed
+ **/
+typedef struct {
+    uint64_t key_offset;
+    uint64_t pilot_offset;
+    uint64_t remap_offset;
+    uint32_t nkeys;
+    uint32_t nbuckets;
+    uint32_t table_size;
+    uint32_t seed;
+} mphf_partition_t;
+
+/**
+ * @brief Minimal perfect hash function (PTHash-style, partitioned)
+ *
+ * All tables live in one contiguous block, which is the serialized form.
+ *
+ * @param mapped base is a file mapping (munmap on free)
+ * @param owned base is heap memory (free on free)
+ **/
+typedef struct {
+    const mphf_header_t* header;
+    const mphf_partition_t* partitions;
+    const uint16_t* pilots;
+    const uint16_t* remap;
+    void* base;
+    size_t size;
+    int mapped;
+    int owned;
+} mphf_t;
+
+/**
+ * @brief 64-bit key hash used by mphf_build and mphf_lookup (two jenkins_hash passes)
+ *
+ * @param key
+ * @param len
+ * @param seed
+ * @return uint64_t
+ **/
+uint64_t mphf_hash_key(const void* key, size_t len, uint32_t seed);
+
+/**
+ * @brief 64-bit hash of an integer key, used by mphf_build_u64 and mphf_lookup_u64
+ *
+ * @param key
+ * @param seed
+ * @return uint64_t
+ **/
+uint64_t mphf_hash_u64(uint64_t key, uint32_t seed);
+
+/**
+ * @brief Build minimal perfect hash for distinct byte string keys
+ *
+ * @param keys
+ * @param lens
+ * @param n number of keys
+ * @param nthreads number of workers (0 = all CPUs)
+ * @return mphf_t* NULL on error (errno is EINVAL for duplicate keys, ENOMEM otherwise)
+ **/
+mphf_t* mphf_build(const void* const* keys, const size_t* lens, size_t n, unsigned nthreads);
+
+/**
+ * @brief Build minimal perfect hash for distinct integer keys
+ *
+ * @param keys
+ * @param n number of keys
+ * @param nthreads number of workers (0 = all CPUs)
+ * @return mphf_t* NULL on error (errno is EINVAL for duplicate keys, ENOMEM otherwise)
+ **/
+mphf_t* mphf_build_u64(const uint64_t* keys, size_t n, unsigned nthreads);
+
+/**
+ * @brief Map 64-bit key hash to its index
+ *
+ * @param mphf
+ * @param hash mphf_hash_key or mphf_hash_u64 with mphf->header->seed
+ * @return uint64_t index in [0, nkeys), arbitrary for keys outside the set
+ **/
+uint64_t mphf_lookup_hash(const mphf_t* mphf, uint64_t hash);
+
+/**
+ * @brief Map byte string key to its index
+ *
+ * @param mphf
+ * @param key
+ * @param len
+ * @return uint64_t index in [0, nkeys), arbitrary for keys outside the set
+ **/
+uint64_t mphf_lookup(const mphf_t* mphf, const void* key, size_t len);
+
+/**
+ * @brief Map integer key to its index
+ *
+ * @param mphf
+ * @param key
+ * @return uint64_t index in [0, nkeys), arbitrary for keys outside the set
+ **/
+uint64_t mphf_lookup_u64(const mphf_t* mphf, uint64_t key);
+
+/**
+ * @brief Number of keys
+ *
+ * @param mphf
+ * @return uint64_t
+ **/
+uint64_t mphf_size(const mphf_t* mphf);
+
+/**
+ * @brief Write serialized form to file
+ *
+ * @param mphf
+ * @param path
+ * @return int 0 on success, -1 on error (errno is set)
+ **/
+int mphf_save(const mphf_t* mphf, const char* path);
+
+/**
+ * @brief Map serialized form from file (read-only, no copy)
+ *
+ * @param path
+ * @return mphf_t* NULL on error (errno is set)
+ **/
+mphf_t* mphf_load(const char* path);
+
+/**
+ * @brief Use serialized form in memory (no copy, buffer must outlive the result)
+ *
+ * @param data 8-byte aligned buffer
+ * @param size
+ * @return mphf_t* NULL on invalid data
+ **/
+mphf_t* mphf_from_buffer(const void* data, size_t size);
+
+/**
+ * @brief Free minimal perfect hash (unmaps loaded files)
+ *
+ * @param mphf
+ **/
+void mphf_free(mphf_t* mphf);
+
+#endif    // MPHF_H
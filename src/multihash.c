@@ -0,0 +1,371 @@
+#include "multihash.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "algos.h"
+
+#define FNV1A_OFFSET_BASIS 2166136261u
+#define FNV1A_PRIME 16777619u
+#define JENKINS_INIT 0xdeadbeef
+#define JENKINS_BLOCK 12
+
+// lane lengths live in signed 32-bit SIMD lanes, longer keys go through the scalar path
+#define MULTIHASH_MAX_LANE_LEN 0x7ffffff0u
+
+#define MULTIHASH_PAGE_SIZE 4096
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+#define ROT_V(x, k) _mm256_or_si256(_mm256_slli_epi32((x), (k)), _mm256_srli_epi32((x), 32 - (k)))
+
+static inline uint32_t load_le32(const uint8_t* p) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline uint32_t load_le32_partial(const uint8_t* p, size_t len) {
+    if (len >= 4) {
+        return load_le32(p);
+    }
+
+    uint32_t w = 0;
+    for (size_t i = 0; i < len; i++) {
+        w |= (uint32_t)p[i] << (8 * i);
+    }
+    return w;
+}
+
+static int lanes_fit(const size_t* lens, int lanes) {
+    for (int l = 0; l < lanes; l++) {
+        if (lens[l] > MULTIHASH_MAX_LANE_LEN) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int use_avx2(const size_t* lens, int lanes) {
+    return __builtin_cpu_supports("avx2") && lanes_fit(lens, lanes);
+}
+
+static inline uint32_t load_lane_le32(const uint8_t* p, size_t len, size_t pos) {
+    return len > pos ? load_le32_partial(p + pos, len - pos) : 0;
+}
+
+// the last whole-word read of a key may run up to 3 bytes past its end,
+// which is harmless as long as it does not step onto the next page
+static int overread_is_safe(const uint8_t* const* p, const size_t* lens, int lanes) {
+    for (int l = 0; l < lanes; l++) {
+        uintptr_t last = (uintptr_t)p[l] + lens[l] - 1;
+        uintptr_t last_read = (uintptr_t)p[l] + ((lens[l] + 3) & ~(size_t)3) - 1;
+        if (lens[l] && last / MULTIHASH_PAGE_SIZE != last_read / MULTIHASH_PAGE_SIZE) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+AVX2_TARGET static inline __m256i load_lanes_size(const size_t* lens) {
+    return _mm256_setr_epi32(
+        (int)lens[0],
+        (int)lens[1],
+        (int)lens[2],
+        (int)lens[3],
+        (int)lens[4],
+        (int)lens[5],
+        (int)lens[6],
+        (int)lens[7]);
+}
+
+AVX2_TARGET static inline __m256i load_lanes_le32(const uint8_t* const* p, const size_t* lens, size_t pos) {
+    return _mm256_setr_epi32(
+        (int)load_lane_le32(p[0], lens[0], pos),
+        (int)load_lane_le32(p[1], lens[1], pos),
+        (int)load_lane_le32(p[2], lens[2], pos),
+        (int)load_lane_le32(p[3], lens[3], pos),
+        (int)load_lane_le32(p[4], lens[4], pos),
+        (int)load_lane_le32(p[5], lens[5], pos),
+        (int)load_lane_le32(p[6], lens[6], pos),
+        (int)load_lane_le32(p[7], lens[7], pos));
+}
+
+// one masked gather per 4 lanes, finished lanes are not touched
+AVX2_TARGET static inline __m256i gather_lanes_le32(
+    const uint8_t* base, __m256i offs_lo, __m256i offs_hi, __m256i active, size_t pos) {
+    __m256i at = _mm256_set1_epi64x((long long)pos);
+    __m128i lo = _mm256_mask_i64gather_epi32(
+        _mm_setzero_si128(),
+        (const int*)base,
+        _mm256_add_epi64(offs_lo, at),
+        _mm256_castsi256_si128(active),
+        1);
+    __m128i hi = _mm256_mask_i64gather_epi32(
+        _mm_setzero_si128(),
+        (const int*)base,
+        _mm256_add_epi64(offs_hi, at),
+        _mm256_extracti128_si256(active, 1),
+        1);
+    return _mm256_set_m128i(hi, lo);
+}
+
+AVX2_TARGET static inline __m256i lane_offsets(const uint8_t* base, const uint8_t* const* p) {
+    return _mm256_setr_epi64x(
+        (long long)((uintptr_t)p[0] - (uintptr_t)base),
+        (long long)((uintptr_t)p[1] - (uintptr_t)base),
+        (long long)((uintptr_t)p[2] - (uintptr_t)base),
+        (long long)((uintptr_t)p[3] - (uintptr_t)base));
+}
+
+AVX2_TARGET static void fnv1a_lanes_avx2(
+    const void* const* keys, const size_t* lens, int nvec, uint32_t* out) {
+    const uint8_t* const* p = (const uint8_t* const*)keys;
+    const uint8_t* base = p[0];
+    const __m256i prime = _mm256_set1_epi32((int)FNV1A_PRIME);
+    const __m256i low_byte = _mm256_set1_epi32(0xff);
+    const int gather = overread_is_safe(p, lens, nvec * 8);
+    __m256i h[2];
+    __m256i lenv[2];
+    __m256i offs[2][2];
+    size_t max_len = 0;
+
+    for (int l = 0; l < nvec * 8; l++) {
+        max_len = lens[l] > max_len ? lens[l] : max_len;
+    }
+
+    for (int v = 0; v < nvec; v++) {
+        h[v] = _mm256_set1_epi32((int)FNV1A_OFFSET_BASIS);
+        lenv[v] = load_lanes_size(lens + v * 8);
+        offs[v][0] = lane_offsets(base, p + v * 8);
+        offs[v][1] = lane_offsets(base, p + v * 8 + 4);
+    }
+
+    for (size_t pos = 0; pos < max_len; pos += 4) {
+        for (int v = 0; v < nvec; v++) {
+            __m256i live = _mm256_cmpgt_epi32(lenv[v], _mm256_set1_epi32((int)pos));
+            __m256i w = gather ? gather_lanes_le32(base, offs[v][0], offs[v][1], live, pos)
+                               : load_lanes_le32(p + v * 8, lens + v * 8, pos);
+
+            // finished lanes keep their hash
+            for (int k = 0; k < 4; k++) {
+                __m256i active = _mm256_cmpgt_epi32(lenv[v], _mm256_set1_epi32((int)(pos + k)));
+                __m256i next =
+                    _mm256_mullo_epi32(_mm256_xor_si256(h[v], _mm256_and_si256(w, low_byte)), prime);
+                h[v] = _mm256_blendv_epi8(h[v], next, active);
+                w = _mm256_srli_epi32(w, 8);
+            }
+        }
+    }
+
+    for (int v = 0; v < nvec; v++) {
+        _mm256_storeu_si256((__m256i*)(out + v * 8), h[v]);
+    }
+}
+
+AVX2_TARGET static inline void jenkins_mix_avx2(__m256i* a, __m256i* b, __m256i* c) {
+    *a = _mm256_sub_epi32(*a, *c);
+    *a = _mm256_xor_si256(*a, ROT_V(*c, 4));
+    *c = _mm256_add_epi32(*c, *b);
+    *b = _mm256_sub_epi32(*b, *a);
+    *b = _mm256_xor_si256(*b, ROT_V(*a, 6));
+    *a = _mm256_add_epi32(*a, *c);
+    *c = _mm256_sub_epi32(*c, *b);
+    *c = _mm256_xor_si256(*c, ROT_V(*b, 8));
+    *b = _mm256_add_epi32(*b, *a);
+    *a = _mm256_sub_epi32(*a, *c);
+    *a = _mm256_xor_si256(*a, ROT_V(*c, 16));
+    *c = _mm256_add_epi32(*c, *b);
+    *b = _mm256_sub_epi32(*b, *a);
+    *b = _mm256_xor_si256(*b, ROT_V(*a, 19));
+    *a = _mm256_add_epi32(*a, *c);
+    *c = _mm256_sub_epi32(*c, *b);
+    *c = _mm256_xor_si256(*c, ROT_V(*b, 4));
+    *b = _mm256_add_epi32(*b, *a);
+}
+
+AVX2_TARGET static inline void jenkins_final_avx2(__m256i* a, __m256i* b, __m256i* c) {
+    *c = _mm256_xor_si256(*c, *b);
+    *c = _mm256_sub_epi32(*c, ROT_V(*b, 14));
+    *a = _mm256_xor_si256(*a, *c);
+    *a = _mm256_sub_epi32(*a, ROT_V(*c, 11));
+    *b = _mm256_xor_si256(*b, *a);
+    *b = _mm256_sub_epi32(*b, ROT_V(*a, 25));
+    *c = _mm256_xor_si256(*c, *b);
+    *c = _mm256_sub_epi32(*c, ROT_V(*b, 16));
+    *a = _mm256_xor_si256(*a, *c);
+    *a = _mm256_sub_epi32(*a, ROT_V(*c, 4));
+    *b = _mm256_xor_si256(*b, *a);
+    *b = _mm256_sub_epi32(*b, ROT_V(*a, 14));
+    *c = _mm256_xor_si256(*c, *b);
+    *c = _mm256_sub_epi32(*c, ROT_V(*b, 24));
+}
+
+// masks a gathered tail word down to its valid bytes, lanes without any get no load at all
+AVX2_TARGET static inline __m256i gather_tail_le32(
+    const uint8_t* base, const __m256i* offs, __m256i tail_pos, __m256i rem, int word) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i valid = _mm256_min_epi32(
+        _mm256_max_epi32(_mm256_sub_epi32(rem, _mm256_set1_epi32(4 * word)), zero), _mm256_set1_epi32(4));
+    __m256i live = _mm256_cmpgt_epi32(valid, zero);
+    __m256i at_lo = _mm256_add_epi64(offs[0], _mm256_cvtepi32_epi64(_mm256_castsi256_si128(tail_pos)));
+    __m256i at_hi = _mm256_add_epi64(offs[1], _mm256_cvtepi32_epi64(_mm256_extracti128_si256(tail_pos, 1)));
+    __m256i w = gather_lanes_le32(base, at_lo, at_hi, live, 4 * word);
+    __m256i keep = _mm256_srlv_epi32(
+        _mm256_set1_epi32(-1), _mm256_sub_epi32(_mm256_set1_epi32(32), _mm256_slli_epi32(valid, 3)));
+    return _mm256_and_si256(w, keep);
+}
+
+AVX2_TARGET static void jenkins_lanes_avx2(
+    const void* const* keys, const size_t* lens, uint32_t initval, int nvec, uint32_t* out) {
+    const uint8_t* const* p = (const uint8_t* const*)keys;
+    const uint8_t* base = p[0];
+    const int gather = overread_is_safe(p, lens, nvec * 8);
+    __m256i a[2], b[2], c[2];
+    __m256i blocks[2];
+    __m256i offs[2][2];
+    size_t max_blocks = 0;
+
+    for (int v = 0; v < nvec; v++) {
+        __m256i lenv = load_lanes_size(lens + v * 8);
+        a[v] = b[v] = c[v] = _mm256_add_epi32(lenv, _mm256_set1_epi32((int)(JENKINS_INIT + initval)));
+        offs[v][0] = lane_offsets(base, p + v * 8);
+        offs[v][1] = lane_offsets(base, p + v * 8 + 4);
+
+        size_t nblk[8];
+        for (int l = 0; l < 8; l++) {
+            nblk[l] = lens[v * 8 + l] / JENKINS_BLOCK;
+            max_blocks = nblk[l] > max_blocks ? nblk[l] : max_blocks;
+        }
+        blocks[v] = load_lanes_size(nblk);
+    }
+
+    for (size_t j = 0; j < max_blocks; j++) {
+        size_t off = j * JENKINS_BLOCK;
+
+        for (int v = 0; v < nvec; v++) {
+            __m256i active = _mm256_cmpgt_epi32(blocks[v], _mm256_set1_epi32((int)j));
+            __m256i wa, wb, wc;
+
+            if (gather) {
+                wa = gather_lanes_le32(base, offs[v][0], offs[v][1], active, off);
+                wb = gather_lanes_le32(base, offs[v][0], offs[v][1], active, off + 4);
+                wc = gather_lanes_le32(base, offs[v][0], offs[v][1], active, off + 8);
+            } else {
+                size_t block_end[8];
+                for (int l = 0; l < 8; l++) {
+                    block_end[l] = lens[v * 8 + l] / JENKINS_BLOCK > j ? off + JENKINS_BLOCK : 0;
+                }
+                wa = load_lanes_le32(p + v * 8, block_end, off);
+                wb = load_lanes_le32(p + v * 8, block_end, off + 4);
+                wc = load_lanes_le32(p + v * 8, block_end, off + 8);
+            }
+
+            __m256i na = _mm256_add_epi32(a[v], wa);
+            __m256i nb = _mm256_add_epi32(b[v], wb);
+            __m256i nc = _mm256_add_epi32(c[v], wc);
+            jenkins_mix_avx2(&na, &nb, &nc);
+
+            a[v] = _mm256_blendv_epi8(a[v], na, active);
+            b[v] = _mm256_blendv_epi8(b[v], nb, active);
+            c[v] = _mm256_blendv_epi8(c[v], nc, active);
+        }
+    }
+
+    for (int v = 0; v < nvec; v++) {
+        __m256i ta, tb, tc;
+
+        if (gather) {
+            __m256i tail_pos = _mm256_mullo_epi32(blocks[v], _mm256_set1_epi32(JENKINS_BLOCK));
+            __m256i rem = _mm256_sub_epi32(load_lanes_size(lens + v * 8), tail_pos);
+            ta = gather_tail_le32(base, offs[v], tail_pos, rem, 0);
+            tb = gather_tail_le32(base, offs[v], tail_pos, rem, 1);
+            tc = gather_tail_le32(base, offs[v], tail_pos, rem, 2);
+        } else {
+            const uint8_t* tail[8];
+            size_t rem[8];
+            for (int l = 0; l < 8; l++) {
+                size_t len = lens[v * 8 + l];
+                rem[l] = len % JENKINS_BLOCK;
+                tail[l] = p[v * 8 + l] + (len - rem[l]);
+            }
+            ta = load_lanes_le32(tail, rem, 0);
+            tb = load_lanes_le32(tail, rem, 4);
+            tc = load_lanes_le32(tail, rem, 8);
+        }
+
+        a[v] = _mm256_add_epi32(a[v], ta);
+        b[v] = _mm256_add_epi32(b[v], tb);
+        c[v] = _mm256_add_epi32(c[v], tc);
+        jenkins_final_avx2(&a[v], &b[v], &c[v]);
+        _mm256_storeu_si256((__m256i*)(out + v * 8), c[v]);
+    }
+}
+
+void fnv1a_hash_x8(const void* const* keys, const size_t* lens, uint32_t* out) {
+    if (use_avx2(lens, MULTIHASH_LANES_X8)) {
+        fnv1a_lanes_avx2(keys, lens, 1, out);
+        return;
+    }
+
+    for (int l = 0; l < MULTIHASH_LANES_X8; l++) {
+        out[l] = fnv1a_hash(keys[l], lens[l]);
+    }
+}
+
+void fnv1a_hash_x16(const void* const* keys, const size_t* lens, uint32_t* out) {
+    if (use_avx2(lens, MULTIHASH_LANES_X16)) {
+        fnv1a_lanes_avx2(keys, lens, 2, out);
+        return;
+    }
+
+    for (int l = 0; l < MULTIHASH_LANES_X16; l++) {
+        out[l] = fnv1a_hash(keys[l], lens[l]);
+    }
+}
+
+void jenkins_hash_x8(const void* const* keys, const size_t* lens, uint32_t initval, uint32_t* out) {
+    if (use_avx2(lens, MULTIHASH_LANES_X8)) {
+        jenkins_lanes_avx2(keys, lens, initval, 1, out);
+        return;
+    }
+
+    for (int l = 0; l < MULTIHASH_LANES_X8; l++) {
+        out[l] = jenkins_hash(keys[l], lens[l], initval);
+    }
+}
+
+void jenkins_hash_x16(const void* const* keys, const size_t* lens, uint32_t initval, uint32_t* out) {
+    if (use_avx2(lens, MULTIHASH_LANES_X16)) {
+        jenkins_lanes_avx2(keys, lens, initval, 2, out);
+        return;
+    }
+
+    for (int l = 0; l < MULTIHASH_LANES_X16; l++) {
+        out[l] = jenkins_hash(keys[l], lens[l], initval);
+    }
+}
+
+void fnv1a_hash_batch(const void* const* keys, const size_t* lens, size_t n, uint32_t* out) {
+    size_t i = 0;
+
+    for (; i + MULTIHASH_LANES_X16 <= n; i += MULTIHASH_LANES_X16) {
+        fnv1a_hash_x16(keys + i, lens + i, out + i);
+    }
+    for (; i < n; i++) {
+        out[i] = fnv1a_hash(keys[i], lens[i]);
+    }
+}
+
+void jenkins_hash_batch(
+    const void* const* keys, const size_t* lens, size_t n, uint32_t initval, uint32_t* out) {
+    size_t i = 0;
+
+    for (; i + MULTIHASH_LANES_X16 <= n; i += MULTIHASH_LANES_X16) {
+        jenkins_hash_x16(keys + i, lens + i, initval, out + i);
+    }
+    for (; i < n; i++) {
+        out[i] = jenkins_hash(keys[i], lens[i], initval);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef MULTIHASH_H
+#define MULTIHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MULTIHASH_LANES_X8 8
+#define MULTIHASH_LANES_X16 16
+
+/**
+ * @brief FNV-1a hash of 8 independent keys at once (one key per SIMD lane)
+ *
+ * Result for every lane is identical to fnv1a_hash(keys[i], lens[i]).
+ * Keys may have different lengths, finished lanes are masked out.
+ *
+ * @param keys array of 8 key pointers
+ * @param lens array of 8 key lengths
+ * @param out array of 8 hashes
+ **/
+void fnv1a_hash_x8(const void* const* keys, const size_t* lens, uint32_t* out);
+
+/**
+ * @brief FNV-1a hash of 16 independent keys at once (two interleaved SIMD chains)
+ *
+ * @param keys array of 16 key pointers
+ * @param lens array of 16 key lengths
+ * @param out array of 16 hashes
+ **/
+void fnv1a_hash_x16(const void* const* keys, const size_t* lens, uint32_t* out);
+
+/**
+ * @brief Jenkins (lookup3) hash of 8 independent keys at once
+ *
+ * Result for every lane is identical to jenkins_hash(keys[i], lens[i], initval).
+ *
+ * @param keys array of 8 key pointers
+ * @param lens array of 8 key lengths
+ * @param initval seed shared by all lanes
+ * @param out array of 8 hashes
+ **/
+void jenkins_hash_x8(const void* const* keys, const size_t* lens, uint32_t initval, uint32_t* out);
+
+/**
+ * @brief Jenkins (lookup3) hash of 16 independent keys at once
+ *
+ * @param keys array of 16 key pointers
+ * @param lens array of 16 key lengths
+ * @param initval seed shared by all lanes
+ * @param out array of 16 hashes
+ **/
+void jenkins_hash_x16(const void* const* keys, const size_t* lens, uint32_t initval, uint32_t* out);
+
+/**
+ * @brief Hash an array of keys by FNV-1a, 16 keys per step
+ *
+ * @param keys key pointers
+ * @param lens key lengths
+ * @param n number of keys
+ * @param out hashes
+ **/
+void fnv1a_hash_batch(const void* const* keys, const size_t* lens, size_t n, uint32_t* out);
+
+/**
+ * @brief Hash an array of keys by Jenkins hash, 16 keys per step
+ *
+ * @param keys key pointers
+ * @param lens key lengths
+ * @param n number of keys
+ * @param initval seed
+ * @param out hashes
+ **/
+void jenkins_hash_batch(
+    const void* const* keys, const size_t* lens, size_t n, uint32_t initval, uint32_t* out);
+
+#endif    // MULTIHASH_H
@@ -0,0 +1,463 @@
+#include "neardup.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "algos.h"
+#include "levenshtein.h"
+#include "simd_fmix.h"
+#include "threadpool.h"
+
+// documents per signature task and candidate pairs per verification task
+#define NEARDUP_DOCS_PER_TASK 64
+#define NEARDUP_PAIRS_PER_TASK 256
+// shingle hashes simhash keeps on the stack at once
+#define SIMHASH_CHUNK 256
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx512dq")))
+
+typedef struct {
+    uint64_t key;
+    uint32_t doc;
+} lsh_entry_t;
+
+typedef struct {
+    const minhash_params_t* params;
+    const char* const* docs;
+    const size_t* lens;
+    size_t n;
+    uint32_t shingle_len;
+    uint32_t* sigs;
+    uint64_t* fingerprints;
+    int failed;
+} neardup_job_t;
+
+typedef struct {
+    const char* const* docs;
+    const size_t* lens;
+    const neardup_pair_t* pairs;
+    size_t npairs;
+    double max_edit_ratio;
+    uint8_t* keep;
+    int failed;
+} neardup_verify_job_t;
+
+int minhash_init(
+    minhash_params_t* params, uint32_t num_hashes, uint32_t bands, uint32_t shingle_len, uint64_t seed) {
+    if (num_hashes == 0 || num_hashes % 8 || num_hashes > MINHASH_MAX_HASHES || bands == 0
+        || num_hashes % bands || shingle_len == 0) {
+        return -1;
+    }
+
+    params->num_hashes = num_hashes;
+    params->bands = bands;
+    params->rows = num_hashes / bands;
+    params->shingle_len = shingle_len;
+    for (uint32_t i = 0; i < num_hashes; i++) {
+        params->seeds[i] = fmix64(seed + (i + 1) * 0x9e3779b97f4a7c15ULL);
+    }
+    return 0;
+}
+
+static size_t shingle_count(size_t len, uint32_t shingle_len) {
+    if (len == 0) {
+        return 0;
+    }
+    return len > shingle_len ? len - shingle_len + 1 : 1;
+}
+
+// one 64-bit hash per shingle, documents shorter than a shingle are one shingle
+static void shingle_hashes(const char* text, size_t len, uint32_t shingle_len, uint64_t* out) {
+    size_t count = shingle_count(len, shingle_len);
+    size_t width = len < shingle_len ? len : shingle_len;
+
+    for (size_t i = 0; i < count; i++) {
+        out[i] = fmix64(jenkins_hash(text + i, width, 0));
+    }
+}
+
+static void minhash_scalar(const minhash_params_t* params, const uint64_t* x, size_t count, uint32_t* sig) {
+    for (uint32_t j = 0; j < params->num_hashes; j++) {
+        uint64_t min = UINT64_MAX;
+        for (size_t i = 0; i < count; i++) {
+            uint64_t h = fmix64(x[i] ^ params->seeds[j]);
+            min = h < min ? h : min;
+        }
+        sig[j] = (uint32_t)(min >> 32);
+    }
+}
+
+AVX2_TARGET static void minhash_avx2(
+    const minhash_params_t* params, const uint64_t* x, size_t count, uint32_t* sig) {
+    for (uint32_t j = 0; j < params->num_hashes; j += 4) {
+        __m256i seeds = _mm256_loadu_si256((const __m256i*)(params->seeds + j));
+        __m256i min = _mm256_set1_epi64x(-1);
+
+        for (size_t i = 0; i < count; i++) {
+            __m256i h = fmix64_avx2(_mm256_xor_si256(_mm256_set1_epi64x((long long)x[i]), seeds));
+            min = _mm256_blendv_epi8(min, h, cmpgt_epu64_avx2(min, h));
+        }
+
+        uint64_t lanes[4];
+        _mm256_storeu_si256((__m256i*)lanes, min);
+        for (int l = 0; l < 4; l++) {
+            sig[j + l] = (uint32_t)(lanes[l] >> 32);
+        }
+    }
+}
+
+// eight hash functions per vector, the minimum stays in a register across all shingles
+AVX512_TARGET static void minhash_avx512(
+    const minhash_params_t* params, const uint64_t* x, size_t count, uint32_t* sig) {
+    for (uint32_t j = 0; j < params->num_hashes; j += 8) {
+        __m512i seeds = _mm512_loadu_si512(params->seeds + j);
+        __m512i min = _mm512_set1_epi64(-1);
+
+        for (size_t i = 0; i < count; i++) {
+            __m512i h = fmix64_avx512(_mm512_xor_si512(_mm512_set1_epi64((long long)x[i]), seeds));
+            min = _mm512_min_epu64(min, h);
+        }
+        _mm256_storeu_si256((__m256i*)(sig + j), _mm512_cvtepi64_epi32(_mm512_srli_epi64(min, 32)));
+    }
+}
+
+static void minhash_from_shingles(
+    const minhash_params_t* params, const uint64_t* x, size_t count, uint32_t* sig) {
+    if (__builtin_cpu_supports("avx512dq")) {
+        minhash_avx512(params, x, count, sig);
+    } else if (__builtin_cpu_supports("avx2")) {
+        minhash_avx2(params, x, count, sig);
+    } else {
+        minhash_scalar(params, x, count, sig);
+    }
+}
+
+int minhash_signature(const minhash_params_t* params, const char* text, size_t len, uint32_t* sig) {
+    size_t count = shingle_count(len, params->shingle_len);
+    uint64_t* x = malloc((count ? count : 1) * sizeof(uint64_t));
+    if (!x) {
+        return -1;
+    }
+
+    shingle_hashes(text, len, params->shingle_len, x);
+    minhash_from_shingles(params, x, count, sig);
+    free(x);
+    return 0;
+}
+
+static void minhash_task(void* ctx, size_t task) {
+    neardup_job_t* job = (neardup_job_t*)ctx;
+    const minhash_params_t* params = job->params;
+    size_t first = task * NEARDUP_DOCS_PER_TASK;
+    size_t last = job->n - first < NEARDUP_DOCS_PER_TASK ? job->n : first + NEARDUP_DOCS_PER_TASK;
+
+    // one scratch buffer for the longest document of the block
+    size_t max_count = 1;
+    for (size_t d = first; d < last; d++) {
+        size_t count = shingle_count(job->lens[d], params->shingle_len);
+        max_count = count > max_count ? count : max_count;
+    }
+
+    uint64_t* x = malloc(max_count * sizeof(uint64_t));
+    if (!x) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (size_t d = first; d < last; d++) {
+        shingle_hashes(job->docs[d], job->lens[d], params->shingle_len, x);
+        minhash_from_shingles(
+            params, x, shingle_count(job->lens[d], params->shingle_len), job->sigs + d * params->num_hashes);
+    }
+    free(x);
+}
+
+int minhash_signatures(
+    const minhash_params_t* params,
+    const char* const* docs,
+    const size_t* lens,
+    size_t n,
+    uint32_t* sigs,
+    unsigned nthreads) {
+    neardup_job_t job = { .params = params, .docs = docs, .lens = lens, .n = n, .sigs = sigs, .failed = 0 };
+
+    threadpool_run((n + NEARDUP_DOCS_PER_TASK - 1) / NEARDUP_DOCS_PER_TASK, minhash_task, &job, nthreads);
+    return job.failed ? -1 : 0;
+}
+
+double minhash_similarity(const uint32_t* a, const uint32_t* b, uint32_t num_hashes) {
+    uint32_t same = 0;
+
+    for (uint32_t i = 0; i < num_hashes; i++) {
+        same += a[i] == b[i];
+    }
+    return (double)same / num_hashes;
+}
+
+static int lsh_compare_entries(const void* a, const void* b) {
+    const lsh_entry_t* x = (const lsh_entry_t*)a;
+    const lsh_entry_t* y = (const lsh_entry_t*)b;
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return (x->doc > y->doc) - (x->doc < y->doc);
+}
+
+static int neardup_compare_pairs(const void* a, const void* b) {
+    const neardup_pair_t* x = (const neardup_pair_t*)a;
+    const neardup_pair_t* y = (const neardup_pair_t*)b;
+    if (x->a != y->a) {
+        return x->a < y->a ? -1 : 1;
+    }
+    return (x->b > y->b) - (x->b < y->b);
+}
+
+int lsh_candidates(
+    const minhash_params_t* params, const uint32_t* sigs, size_t n, neardup_pair_t** pairs, size_t* npairs) {
+    size_t nentries = n * params->bands;
+    lsh_entry_t* entries = malloc((nentries ? nentries : 1) * sizeof(lsh_entry_t));
+
+    *pairs = NULL;
+    *npairs = 0;
+    if (!entries) {
+        return -1;
+    }
+
+    for (size_t d = 0; d < n; d++) {
+        const uint32_t* sig = sigs + d * params->num_hashes;
+        for (uint32_t band = 0; band < params->bands; band++) {
+            uint32_t h = jenkins_hash(sig + band * params->rows, params->rows * sizeof(uint32_t), band);
+            entries[d * params->bands + band] = (lsh_entry_t){ (uint64_t)band << 32 | h, (uint32_t)d };
+        }
+    }
+    qsort(entries, nentries, sizeof(lsh_entry_t), lsh_compare_entries);
+
+    size_t cap = 0;
+    size_t len = 0;
+    neardup_pair_t* out = NULL;
+    for (size_t start = 0; start < nentries;) {
+        size_t end = start + 1;
+        while (end < nentries && entries[end].key == entries[start].key) {
+            end++;
+        }
+
+        for (size_t i = start; i < end; i++) {
+            for (size_t j = i + 1; j < end; j++) {
+                if (len == cap) {
+                    cap = cap ? cap * 2 : 1024;
+                    neardup_pair_t* grown = realloc(out, cap * sizeof(neardup_pair_t));
+                    if (!grown) {
+                        free(out);
+                        free(entries);
+                        return -1;
+                    }
+                    out = grown;
+                }
+                out[len++] = (neardup_pair_t){ entries[i].doc, entries[j].doc };
+            }
+        }
+        start = end;
+    }
+    free(entries);
+
+    // a pair sharing several bands is reported once
+    qsort(out, len, sizeof(neardup_pair_t), neardup_compare_pairs);
+    size_t unique = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (unique == 0 || out[unique - 1].a != out[i].a || out[unique - 1].b != out[i].b) {
+            out[unique++] = out[i];
+        }
+    }
+
+    *pairs = out;
+    *npairs = unique;
+    return 0;
+}
+
+// adds to the per-bit vote counts, eight bits per vector
+AVX2_TARGET static void simhash_count_avx2(const uint64_t* x, size_t count, uint32_t* votes) {
+    const __m256i shifts = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i acc[8];
+
+    for (int v = 0; v < 8; v++) {
+        acc[v] = _mm256_loadu_si256((const __m256i*)(votes + v * 8));
+    }
+    for (size_t i = 0; i < count; i++) {
+        __m256i lo = _mm256_set1_epi32((int)(uint32_t)x[i]);
+        __m256i hi = _mm256_set1_epi32((int)(uint32_t)(x[i] >> 32));
+        for (int v = 0; v < 4; v++) {
+            __m256i shift = _mm256_add_epi32(shifts, _mm256_set1_epi32(v * 8));
+            acc[v] = _mm256_add_epi32(acc[v], _mm256_and_si256(_mm256_srlv_epi32(lo, shift), one));
+            acc[v + 4] = _mm256_add_epi32(acc[v + 4], _mm256_and_si256(_mm256_srlv_epi32(hi, shift), one));
+        }
+    }
+    for (int v = 0; v < 8; v++) {
+        _mm256_storeu_si256((__m256i*)(votes + v * 8), acc[v]);
+    }
+}
+
+static void simhash_votes(const uint64_t* x, size_t count, uint32_t* votes) {
+    if (__builtin_cpu_supports("avx2")) {
+        simhash_count_avx2(x, count, votes);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            for (int b = 0; b < 64; b++) {
+                votes[b] += (x[i] >> b) & 1;
+            }
+        }
+    }
+}
+
+// shingle hashes only depend on the shingle bytes, so they are hashed and counted a stack chunk at a time
+uint64_t simhash(const char* text, size_t len, uint32_t shingle_len) {
+    size_t count = shingle_count(len, shingle_len);
+    size_t width = len < shingle_len ? len : shingle_len;
+    uint64_t x[SIMHASH_CHUNK];
+    uint32_t votes[64] = { 0 };
+    uint64_t fingerprint = 0;
+
+    for (size_t first = 0; first < count; first += SIMHASH_CHUNK) {
+        size_t chunk = count - first < SIMHASH_CHUNK ? count - first : SIMHASH_CHUNK;
+        shingle_hashes(text + first, chunk + width - 1, shingle_len, x);
+        simhash_votes(x, chunk, votes);
+    }
+
+    for (int b = 0; b < 64; b++) {
+        if (2 * (size_t)votes[b] > count) {
+            fingerprint |= 1ULL << b;
+        }
+    }
+    return fingerprint;
+}
+
+static void simhash_task(void* ctx, size_t task) {
+    neardup_job_t* job = (neardup_job_t*)ctx;
+    size_t first = task * NEARDUP_DOCS_PER_TASK;
+    size_t last = job->n - first < NEARDUP_DOCS_PER_TASK ? job->n : first + NEARDUP_DOCS_PER_TASK;
+
+    for (size_t d = first; d < last; d++) {
+        job->fingerprints[d] = simhash(job->docs[d], job->lens[d], job->shingle_len);
+    }
+}
+
+void simhash_bulk(
+    const char* const* docs,
+    const size_t* lens,
+    size_t n,
+    uint32_t shingle_len,
+    uint64_t* out,
+    unsigned nthreads) {
+    neardup_job_t job = {
+        .docs = docs,
+        .lens = lens,
+        .n = n,
+        .shingle_len = shingle_len,
+        .fingerprints = out,
+    };
+
+    threadpool_run((n + NEARDUP_DOCS_PER_TASK - 1) / NEARDUP_DOCS_PER_TASK, simhash_task, &job, nthreads);
+}
+
+int simhash_distance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+static void neardup_verify_task(void* ctx, size_t task) {
+    neardup_verify_job_t* job = (neardup_verify_job_t*)ctx;
+    size_t first = task * NEARDUP_PAIRS_PER_TASK;
+    size_t last = job->npairs - first < NEARDUP_PAIRS_PER_TASK ? job->npairs
+                                                               : first + NEARDUP_PAIRS_PER_TASK;
+
+    for (size_t i = first; i < last; i++) {
+        size_t la = job->lens[job->pairs[i].a];
+        size_t lb = job->lens[job->pairs[i].b];
+        double limit = job->max_edit_ratio * (double)(la > lb ? la : lb);
+
+        // the length difference is a lower bound of the edit distance
+        double diff = la > lb ? (double)(la - lb) : (double)(lb - la);
+        if (diff > limit) {
+            job->keep[i] = 0;
+            continue;
+        }
+        const uint8_t* a = (const uint8_t*)job->docs[job->pairs[i].a];
+        const uint8_t* b = (const uint8_t*)job->docs[job->pairs[i].b];
+        int distance = levenshtein_bytes(a, la, b, lb);
+        if (distance < 0) {
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        job->keep[i] = distance <= limit;
+    }
+}
+
+int neardup_find(
+    const minhash_params_t* params,
+    const char* const* docs,
+    size_t n,
+    double max_edit_ratio,
+    unsigned nthreads,
+    neardup_pair_t** pairs,
+    size_t* npairs) {
+    size_t* lens = malloc((n ? n : 1) * sizeof(size_t));
+    uint32_t* sigs = malloc((n ? n : 1) * params->num_hashes * sizeof(uint32_t));
+
+    *pairs = NULL;
+    *npairs = 0;
+    if (!lens || !sigs) {
+        free(lens);
+        free(sigs);
+        return -1;
+    }
+    for (size_t d = 0; d < n; d++) {
+        lens[d] = strlen(docs[d]);
+    }
+
+    neardup_pair_t* candidates = NULL;
+    size_t ncandidates = 0;
+    if (minhash_signatures(params, docs, lens, n, sigs, nthreads) < 0
+        || lsh_candidates(params, sigs, n, &candidates, &ncandidates) < 0) {
+        free(lens);
+        free(sigs);
+        return -1;
+    }
+    free(sigs);
+
+    neardup_verify_job_t job = {
+        .docs = docs,
+        .lens = lens,
+        .pairs = candidates,
+        .npairs = ncandidates,
+        .max_edit_ratio = max_edit_ratio,
+        .keep = malloc(ncandidates ? ncandidates : 1),
+        .failed = 0,
+    };
+    if (!job.keep) {
+        free(lens);
+        free(candidates);
+        return -1;
+    }
+    size_t ntasks = (ncandidates + NEARDUP_PAIRS_PER_TASK - 1) / NEARDUP_PAIRS_PER_TASK;
+    threadpool_run(ntasks, neardup_verify_task, &job, nthreads);
+    if (job.failed) {
+        free(job.keep);
+        free(lens);
+        free(candidates);
+        return -1;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < ncandidates; i++) {
+        if (job.keep[i]) {
+            candidates[kept++] = candidates[i];
+        }
+    }
+
+    free(job.keep);
+    free(lens);
+    *pairs = candidates;
+    *npairs = kept;
+    return 0;
+}
@@ -0,0 +1,162 @@
+#ifndef NEARDUP_H
+#define NEARDUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MINHASH_MAX_HASHES 256
+#define MINHASH_DEFAULT_SHINGLE 5
+
+/**
+ * @brief MinHash / LSH parameters
+ *
+ * Hash function i maps a shingle hash x to fmix64(x ^ seeds[i]). Signatures are split
+ * into bands of rows hashes; two documents become candidates when any band matches,
+ * which happens with probability 1 - (1 - s^rows)^bands for Jaccard similarity s.
+ *
+ * @param num_hashes signature length (bands * rows)
+ * @param bands LSH bands
+ * @param rows hashes per band
+ * @param shingle_len bytes per shingle
+ * @param seeds per-function seeds
+ **/
+typedef struct {
+    uint32_t num_hashes;
+    uint32_t bands;
+    uint32_t rows;
+    uint32_t shingle_len;
+    uint64_t seeds[MINHASH_MAX_HASHES];
+} minhash_params_t;
+
+typedef struct {
+    uint32_t a;
+    uint32_t b;
+} neardup_pair_t;
+
+/**
+ * @brief Initialize MinHash parameters
+ *
+ * @param params
+ * @param num_hashes signature length, multiple of 8 up to MINHASH_MAX_HASHES
+ * @param bands divides num_hashes
+ * @param shingle_len bytes per shingle
+ * @param seed
+ * @return int 0 on success, -1 on invalid parameters
+ **/
+int minhash_init(
+    minhash_params_t* params, uint32_t num_hashes, uint32_t bands, uint32_t shingle_len, uint64_t seed);
+
+/**
+ * @brief MinHash signature of a document (AVX-512 or AVX2 if supported)
+ *
+ * @param params
+ * @param text
+ * @param len
+ * @param sig num_hashes values
+ * @return int 0 on success, -1 on allocation error
+ **/
+int minhash_signature(const minhash_params_t* params, const char* text, size_t len, uint32_t* sig);
+
+/**
+ * @brief MinHash signatures of many documents on a thread pool
+ *
+ * @param params
+ * @param docs
+ * @param lens
+ * @param n number of documents
+ * @param sigs n * num_hashes values
+ * @param nthreads number of workers (0 = all CPUs)
+ * @return int 0 on success, -1 on allocation error
+ **/
+int minhash_signatures(
+    const minhash_params_t* params,
+    const char* const* docs,
+    const size_t* lens,
+    size_t n,
+    uint32_t* sigs,
+    unsigned nthreads);
+
+/**
+ * @brief Estimated Jaccard similarity of two signatures
+ *
+ * @param a
+ * @param b
+ * @param num_hashes
+ * @return double
+ **/
+double minhash_similarity(const uint32_t* a, const uint32_t* b, uint32_t num_hashes);
+
+/**
+ * @brief Candidate pairs that share at least one LSH band, O(n * bands log n)
+ *
+ * @param params
+ * @param sigs n * num_hashes values
+ * @param n number of documents
+ * @param pairs unique pairs with a < b (free with free())
+ * @param npairs
+ * @return int 0 on success, -1 on allocation error
+ **/
+int lsh_candidates(
+    const minhash_params_t* params, const uint32_t* sigs, size_t n, neardup_pair_t** pairs, size_t* npairs);
+
+/**
+ * @brief SimHash fingerprint of a document, similar documents differ in few bits
+ *
+ * Needs no heap memory and cannot fail.
+ *
+ * @param text
+ * @param len
+ * @param shingle_len bytes per shingle
+ * @return uint64_t
+ **/
+uint64_t simhash(const char* text, size_t len, uint32_t shingle_len);
+
+/**
+ * @brief SimHash fingerprints of many documents on a thread pool
+ *
+ * @param docs
+ * @param lens
+ * @param n number of documents
+ * @param shingle_len
+ * @param out n fingerprints
+ * @param nthreads number of workers (0 = all CPUs)
+ **/
+void simhash_bulk(
+    const char* const* docs,
+    const size_t* lens,
+    size_t n,
+    uint32_t shingle_len,
+    uint64_t* out,
+    unsigned nthreads);
+
+/**
+ * @brief Hamming distance of two fingerprints
+ *
+ * @param a
+ * @param b
+ * @return int
+ **/
+int simhash_distance(uint64_t a, uint64_t b);
+
+/**
+ * @brief Near-duplicate pairs: MinHash signatures, LSH candidates, levenshtein verification
+ *
+ * @param params
+ * @param docs NUL-terminated documents
+ * @param n number of documents
+ * @param max_edit_ratio keep pairs with levenshtein <= max_edit_ratio * longer length
+ * @param nthreads number of workers (0 = all CPUs)
+ * @param pairs verified pairs with a < b (free with free())
+ * @param npairs
+ * @return int 0 on success, -1 on allocation error
+ **/
+int neardup_find(
+    const minhash_params_t* params,
+    const char* const* docs,
+    size_t n,
+    double max_edit_ratio,
+    unsigned nthreads,
+    neardup_pair_t** pairs,
+    size_t* npairs);
+
+#endif    // NEARDUP_H
@@ -0,0 +1,234 @@
+#include "shard.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "algos.h"
+#include "simd_fmix.h"
+
+#define JUMP_LCG_MUL 2862933555777941757ULL
+#define SHARD_KEY_SEED 0x9e3779b9u
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx512dq")))
+
+// below this many nodes a plain loop beats the vector setup and reduction
+#define RENDEZVOUS_SIMD_MIN_NODES 16
+
+uint64_t shard_key_hash(const void* key, size_t len) {
+    return fmix64((uint64_t)jenkins_hash(key, len, SHARD_KEY_SEED) | (uint64_t)len << 32);
+}
+
+int32_t jump_consistent_hash(uint64_t key, int32_t num_buckets) {
+    int64_t b = -1;
+    int64_t j = 0;
+
+    if (num_buckets <= 0) {
+        return -1;
+    }
+    while (j < num_buckets) {
+        b = j;
+        key = key * JUMP_LCG_MUL + 1;
+        j = (int64_t)((b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+    }
+    return (int32_t)b;
+}
+
+void jump_consistent_hash_batch(const uint64_t* keys, size_t n, int32_t num_buckets, int32_t* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = jump_consistent_hash(keys[i], num_buckets);
+    }
+}
+
+int rendezvous_init(rendezvous_t* r, const uint64_t* node_ids, size_t nnodes) {
+    r->seeds = NULL;
+    r->nnodes = 0;
+    if (nnodes == 0) {
+        return -1;
+    }
+
+    r->seeds = malloc(nnodes * sizeof(uint64_t));
+    if (!r->seeds) {
+        return -1;
+    }
+    for (size_t i = 0; i < nnodes; i++) {
+        r->seeds[i] = fmix64(node_ids[i]);
+    }
+    r->nnodes = nnodes;
+    return 0;
+}
+
+void rendezvous_free(rendezvous_t* r) {
+    free(r->seeds);
+    r->seeds = NULL;
+    r->nnodes = 0;
+}
+
+uint64_t rendezvous_score(uint64_t key, uint64_t seed) {
+    return fmix64(key ^ seed);
+}
+
+size_t rendezvous_lookup_scalar(const rendezvous_t* r, uint64_t key) {
+    uint64_t best = rendezvous_score(key, r->seeds[0]);
+    size_t best_node = 0;
+
+    for (size_t i = 1; i < r->nnodes; i++) {
+        uint64_t score = rendezvous_score(key, r->seeds[i]);
+        if (score > best) {
+            best = score;
+            best_node = i;
+        }
+    }
+    return best_node;
+}
+
+AVX2_TARGET static size_t rendezvous_lookup_avx2(const rendezvous_t* r, uint64_t key) {
+    const __m256i key_v = _mm256_set1_epi64x((long long)key);
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i node = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i best_node = node;
+    __m256i best = fmix64_avx2(_mm256_xor_si256(key_v, _mm256_loadu_si256((const __m256i*)r->seeds)));
+    size_t i = 4;
+
+    for (; i + 4 <= r->nnodes; i += 4) {
+        node = _mm256_add_epi64(node, step);
+        __m256i seeds = _mm256_loadu_si256((const __m256i*)(r->seeds + i));
+        __m256i score = fmix64_avx2(_mm256_xor_si256(key_v, seeds));
+        __m256i gt = cmpgt_epu64_avx2(score, best);
+        best = _mm256_blendv_epi8(best, score, gt);
+        best_node = _mm256_blendv_epi8(best_node, node, gt);
+    }
+
+    uint64_t lane_best[4];
+    uint64_t lane_node[4];
+    _mm256_storeu_si256((__m256i*)lane_best, best);
+    _mm256_storeu_si256((__m256i*)lane_node, best_node);
+
+    // ties go to the lowest node index, as in the scalar scan
+    uint64_t result_score = lane_best[0];
+    size_t result = lane_node[0];
+    for (int l = 1; l < 4; l++) {
+        if (lane_best[l] > result_score || (lane_best[l] == result_score && lane_node[l] < result)) {
+            result_score = lane_best[l];
+            result = lane_node[l];
+        }
+    }
+    for (; i < r->nnodes; i++) {
+        uint64_t score = rendezvous_score(key, r->seeds[i]);
+        if (score > result_score) {
+            result_score = score;
+            result = i;
+        }
+    }
+    return result;
+}
+
+AVX512_TARGET static size_t rendezvous_lookup_avx512(const rendezvous_t* r, uint64_t key) {
+    const __m512i key_v = _mm512_set1_epi64((long long)key);
+    const __m512i step = _mm512_set1_epi64(8);
+    __m512i node = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    __m512i best_node = node;
+    __m512i best = fmix64_avx512(_mm512_xor_si512(key_v, _mm512_loadu_si512(r->seeds)));
+    size_t i = 8;
+
+    for (; i + 8 <= r->nnodes; i += 8) {
+        node = _mm512_add_epi64(node, step);
+        __m512i score = fmix64_avx512(_mm512_xor_si512(key_v, _mm512_loadu_si512(r->seeds + i)));
+        __mmask8 gt = _mm512_cmpgt_epu64_mask(score, best);
+        best = _mm512_mask_blend_epi64(gt, best, score);
+        best_node = _mm512_mask_blend_epi64(gt, best_node, node);
+    }
+
+    // ties go to the lowest node index, as in the scalar scan
+    uint64_t result_score = _mm512_reduce_max_epu64(best);
+    __mmask8 winners = _mm512_cmpeq_epu64_mask(best, _mm512_set1_epi64((long long)result_score));
+    size_t result = _mm512_mask_reduce_min_epu64(winners, best_node);
+
+    for (; i < r->nnodes; i++) {
+        uint64_t score = rendezvous_score(key, r->seeds[i]);
+        if (score > result_score) {
+            result_score = score;
+            result = i;
+        }
+    }
+    return result;
+}
+
+size_t rendezvous_lookup(const rendezvous_t* r, uint64_t key) {
+    if (r->nnodes < RENDEZVOUS_SIMD_MIN_NODES) {
+        return rendezvous_lookup_scalar(r, key);
+    }
+    if (__builtin_cpu_supports("avx512dq")) {
+        return rendezvous_lookup_avx512(r, key);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return rendezvous_lookup_avx2(r, key);
+    }
+    return rendezvous_lookup_scalar(r, key);
+}
+
+// four keys per vector, every node seed is broadcast to all lanes
+AVX2_TARGET static void rendezvous_lookup_batch_avx2(
+    const rendezvous_t* r, const uint64_t* keys, size_t n, uint32_t* out) {
+    size_t k = 0;
+
+    for (; k + 4 <= n; k += 4) {
+        __m256i key_v = _mm256_loadu_si256((const __m256i*)(keys + k));
+        __m256i best = fmix64_avx2(_mm256_xor_si256(key_v, _mm256_set1_epi64x((long long)r->seeds[0])));
+        __m256i best_node = _mm256_setzero_si256();
+
+        for (size_t i = 1; i < r->nnodes; i++) {
+            __m256i seed = _mm256_set1_epi64x((long long)r->seeds[i]);
+            __m256i score = fmix64_avx2(_mm256_xor_si256(key_v, seed));
+            __m256i gt = cmpgt_epu64_avx2(score, best);
+            best = _mm256_blendv_epi8(best, score, gt);
+            best_node = _mm256_blendv_epi8(best_node, _mm256_set1_epi64x((long long)i), gt);
+        }
+
+        uint64_t lane_node[4];
+        _mm256_storeu_si256((__m256i*)lane_node, best_node);
+        for (int l = 0; l < 4; l++) {
+            out[k + l] = (uint32_t)lane_node[l];
+        }
+    }
+    for (; k < n; k++) {
+        out[k] = (uint32_t)rendezvous_lookup_scalar(r, keys[k]);
+    }
+}
+
+AVX512_TARGET static void rendezvous_lookup_batch_avx512(
+    const rendezvous_t* r, const uint64_t* keys, size_t n, uint32_t* out) {
+    size_t k = 0;
+
+    for (; k + 8 <= n; k += 8) {
+        __m512i key_v = _mm512_loadu_si512(keys + k);
+        __m512i best = fmix64_avx512(_mm512_xor_si512(key_v, _mm512_set1_epi64((long long)r->seeds[0])));
+        __m512i best_node = _mm512_setzero_si512();
+
+        for (size_t i = 1; i < r->nnodes; i++) {
+            __m512i score = fmix64_avx512(_mm512_xor_si512(key_v, _mm512_set1_epi64((long long)r->seeds[i])));
+            __mmask8 gt = _mm512_cmpgt_epu64_mask(score, best);
+            best = _mm512_mask_blend_epi64(gt, best, score);
+            best_node = _mm512_mask_blend_epi64(gt, best_node, _mm512_set1_epi64((long long)i));
+        }
+        _mm256_storeu_si256((__m256i*)(out + k), _mm512_cvtepi64_epi32(best_node));
+    }
+    for (; k < n; k++) {
+        out[k] = (uint32_t)rendezvous_lookup_scalar(r, keys[k]);
+    }
+}
+
+void rendezvous_lookup_batch(const rendezvous_t* r, const uint64_t* keys, size_t n, uint32_t* out) {
+    if (__builtin_cpu_supports("avx512dq")) {
+        rendezvous_lookup_batch_avx512(r, keys, n, out);
+        return;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        rendezvous_lookup_batch_avx2(r, keys, n, out);
+        return;
+    }
+    for (size_t k = 0; k < n; k++) {
+        out[k] = (uint32_t)rendezvous_lookup_scalar(r, keys[k]);
+    }
+}
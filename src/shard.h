@@ -0,0 +1,102 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Rendezvous (highest random weight) node set
+ *
+ * @param seeds per-node hash seed, fmix64 of the node id
+ * @param nnodes number of nodes
+ **/
+typedef struct {
+    uint64_t* seeds;
+    size_t nnodes;
+} rendezvous_t;
+
+/**
+ * @brief 64-bit shard key of a byte string (jenkins_hash spread by fmix64)
+ *
+ * @param key
+ * @param len
+ * @return uint64_t
+ **/
+uint64_t shard_key_hash(const void* key, size_t len);
+
+/**
+ * @brief Jump consistent hash (Lamping, Veach), maps key to bucket in [0, num_buckets)
+ *
+ * Growing num_buckets by one moves only 1/num_buckets of the keys, all of them to the new bucket.
+ *
+ * @param key
+ * @param num_buckets
+ * @return int32_t bucket, -1 if num_buckets <= 0
+ **/
+int32_t jump_consistent_hash(uint64_t key, int32_t num_buckets);
+
+/**
+ * @brief Jump consistent hash of many keys
+ *
+ * @param keys
+ * @param n number of keys
+ * @param num_buckets
+ * @param out buckets
+ **/
+void jump_consistent_hash_batch(const uint64_t* keys, size_t n, int32_t num_buckets, int32_t* out);
+
+/**
+ * @brief Initialize rendezvous node set
+ *
+ * @param r
+ * @param node_ids stable node identifiers (e.g. hashed addresses)
+ * @param nnodes
+ * @return int 0 on success, -1 on allocation error or empty node set
+ **/
+int rendezvous_init(rendezvous_t* r, const uint64_t* node_ids, size_t nnodes);
+
+/**
+ * @brief Free rendezvous node set
+ *
+ * @param r
+ **/
+void rendezvous_free(rendezvous_t* r);
+
+/**
+ * @brief Score of key on node, the node with the highest score owns the key
+ *
+ * @param key
+ * @param seed node seed
+ * @return uint64_t
+ **/
+uint64_t rendezvous_score(uint64_t key, uint64_t seed);
+
+/**
+ * @brief Node owning key, scalar scan over all nodes
+ *
+ * @param r
+ * @param key
+ * @return size_t node index
+ **/
+size_t rendezvous_lookup_scalar(const rendezvous_t* r, uint64_t key);
+
+/**
+ * @brief Node owning key, all nodes are scored in SIMD lanes (AVX-512 or AVX2 if supported)
+ *
+ * @param r
+ * @param key
+ * @return size_t node index
+ **/
+size_t rendezvous_lookup(const rendezvous_t* r, uint64_t key);
+
+/**
+ * @brief Nodes owning many keys, keys are scored in SIMD lanes (AVX-512 or AVX2 if supported)
+ *
+ * @param r
+ * @param keys
+ * @param n number of keys
+ * @param out node indexes
+ **/
+void rendezvous_lookup_batch(const rendezvous_t* r, const uint64_t* keys, size_t n, uint32_t* out);
+
+#endif    // SHARD_H
@@ -0,0 +1,63 @@
+#ifndef SIMD_FMIX_H
+#define SIMD_FMIX_H
+
+#include <immintrin.h>
+#include <stdint.h>
+
+// fmix64 (MurmurHash3 finalizer) on SIMD lanes, shared by the batch hashing modules
+
+/**
+ * @brief 64-bit multiply on 4 lanes, AVX2 has none so it is built from three 32x32->64 products
+ *
+ * @param a
+ * @param b
+ * @return __m256i low 64 bits of a * b
+ **/
+__attribute__((target("avx2"))) static inline __m256i mul64_avx2(__m256i a, __m256i b) {
+    __m256i lo = _mm256_mul_epu32(a, b);
+    __m256i t1 = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+    __m256i t2 = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(_mm256_add_epi64(t1, t2), 32));
+}
+
+/**
+ * @brief Unsigned a > b on 4 lanes, AVX2 only compares signed 64-bit lanes
+ *
+ * @param a
+ * @param b
+ * @return __m256i all-ones lanes where a > b
+ **/
+__attribute__((target("avx2"))) static inline __m256i cmpgt_epu64_avx2(__m256i a, __m256i b) {
+    __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+}
+
+/**
+ * @brief fmix64 on 4 lanes
+ *
+ * @param k
+ * @return __m256i
+ **/
+__attribute__((target("avx2"))) static inline __m256i fmix64_avx2(__m256i k) {
+    k = _mm256_xor_si256(k, _mm256_srli_epi64(k, 33));
+    k = mul64_avx2(k, _mm256_set1_epi64x((long long)0xff51afd7ed558ccdULL));
+    k = _mm256_xor_si256(k, _mm256_srli_epi64(k, 33));
+    k = mul64_avx2(k, _mm256_set1_epi64x((long long)0xc4ceb9fe1a85ec53ULL));
+    return _mm256_xor_si256(k, _mm256_srli_epi64(k, 33));
+}
+
+/**
+ * @brief fmix64 on 8 lanes (AVX-512DQ has a native 64-bit multiply)
+ *
+ * @param k
+ * @return __m512i
+ **/
+__attribute__((target("avx512f,avx512dq"))) static inline __m512i fmix64_avx512(__m512i k) {
+    k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+    k = _mm512_mullo_epi64(k, _mm512_set1_epi64((long long)0xff51afd7ed558ccdULL));
+    k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+    k = _mm512_mullo_epi64(k, _mm512_set1_epi64((long long)0xc4ceb9fe1a85ec53ULL));
+    return _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+}
+
+#endif    // SIMD_FMIX_H
@@ -0,0 +1,64 @@
+#include "threadpool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    threadpool_task_fn fn;
+    void* ctx;
+    size_t ntasks;
+    size_t next;
+} threadpool_job_t;
+
+static void* threadpool_worker(void* arg) {
+    threadpool_job_t* job = (threadpool_job_t*)arg;
+
+    for (;;) {
+        size_t task = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (task >= job->ntasks) {
+            break;
+        }
+        job->fn(job->ctx, task);
+    }
+    return NULL;
+}
+
+unsigned threadpool_default_threads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+}
+
+unsigned threadpool_run(size_t ntasks, threadpool_task_fn fn, void* ctx, unsigned nthreads) {
+    threadpool_job_t job = { .fn = fn, .ctx = ctx, .ntasks = ntasks, .next = 0 };
+
+    if (nthreads == 0) {
+        nthreads = threadpool_default_threads();
+    }
+    if (nthreads > ntasks) {
+        nthreads = ntasks ? (unsigned)ntasks : 1;
+    }
+
+    pthread_t* threads = NULL;
+    unsigned started = 0;
+
+    if (nthreads > 1) {
+        threads = malloc((nthreads - 1) * sizeof(pthread_t));
+        if (threads) {
+            while (started < nthreads - 1
+                   && pthread_create(&threads[started], NULL, threadpool_worker, &job) == 0) {
+                started++;
+            }
+        }
+    }
+
+    // the caller always takes part, so the job completes even if no thread started
+    threadpool_worker(&job);
+
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    return started + 1;
+}
@@ -0,0 +1,29 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stddef.h>
+
+typedef void (*threadpool_task_fn)(void* ctx, size_t task);
+
+/**
+ * @brief Number of online CPUs, used as default worker count
+ *
+ * @return unsigned
+ **/
+unsigned threadpool_default_threads(void);
+
+/**
+ * @brief Run tasks 0..ntasks-1 on a pool of worker threads and wait for all of them
+ *
+ * Workers take the next task index from a shared atomic counter, so uneven tasks
+ * are balanced automatically. The calling thread works as one of the workers.
+ *
+ * @param ntasks number of tasks
+ * @param fn task function, called as fn(ctx, task)
+ * @param ctx user context passed to every task
+ * @param nthreads number of workers (0 = threadpool_default_threads())
+ * @return unsigned number of workers that actually ran (at least 1)
+ **/
+unsigned threadpool_run(size_t ntasks, threadpool_task_fn fn, void* ctx, unsigned nthreads);
+
+#endif    // THREADPOOL_H
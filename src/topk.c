@@ -0,0 +1,344 @@
+#include "topk.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "algos.h"
+#include "threadpool.h"
+
+#define TOPK_NIL UINT32_MAX
+#define TOPK_MAX_CAPACITY (1u << 30)
+
+// events whose index slots are prefetched before the first of them is counted
+#define TOPK_BATCH 32
+
+static uint32_t topk_find(const topk_t* tk, uint64_t hash) {
+    for (uint32_t slot = (uint32_t)hash & tk->index_mask;; slot = (slot + 1) & tk->index_mask) {
+        uint32_t c = tk->index[slot];
+        if (c == 0) {
+            return TOPK_NIL;
+        }
+        if (tk->counters[c - 1].hash == hash) {
+            return c - 1;
+        }
+    }
+}
+
+static void topk_index_insert(topk_t* tk, uint64_t hash, uint32_t counter) {
+    uint32_t slot = (uint32_t)hash & tk->index_mask;
+    while (tk->index[slot]) {
+        slot = (slot + 1) & tk->index_mask;
+    }
+    tk->index[slot] = counter + 1;
+}
+
+// backward shift deletion keeps every probe sequence unbroken without tombstones
+static void topk_index_remove(topk_t* tk, uint64_t hash) {
+    uint32_t slot = (uint32_t)hash & tk->index_mask;
+    while (tk->counters[tk->index[slot] - 1].hash != hash) {
+        slot = (slot + 1) & tk->index_mask;
+    }
+
+    for (uint32_t next = (slot + 1) & tk->index_mask; tk->index[next]; next = (next + 1) & tk->index_mask) {
+        uint32_t home = (uint32_t)tk->counters[tk->index[next] - 1].hash & tk->index_mask;
+        // move the entry into the hole unless its home lies cyclically in (slot, next]
+        if (((next - home) & tk->index_mask) >= ((next - slot) & tk->index_mask)) {
+            tk->index[slot] = tk->index[next];
+            slot = next;
+        }
+    }
+    tk->index[slot] = 0;
+}
+
+static uint32_t topk_bucket_new(topk_t* tk, uint64_t count, uint32_t prev) {
+    uint32_t b = tk->free_bucket;
+    topk_bucket_t* bucket = &tk->buckets[b];
+
+    tk->free_bucket = bucket->next;
+    bucket->count = count;
+    bucket->head = TOPK_NIL;
+    bucket->prev = prev;
+    bucket->next = prev == TOPK_NIL ? tk->min_bucket : tk->buckets[prev].next;
+    if (bucket->next != TOPK_NIL) {
+        tk->buckets[bucket->next].prev = b;
+    }
+    if (prev == TOPK_NIL) {
+        tk->min_bucket = b;
+    } else {
+        tk->buckets[prev].next = b;
+    }
+    return b;
+}
+
+static void topk_bucket_release(topk_t* tk, uint32_t b) {
+    topk_bucket_t* bucket = &tk->buckets[b];
+
+    if (bucket->prev == TOPK_NIL) {
+        tk->min_bucket = bucket->next;
+    } else {
+        tk->buckets[bucket->prev].next = bucket->next;
+    }
+    if (bucket->next != TOPK_NIL) {
+        tk->buckets[bucket->next].prev = bucket->prev;
+    }
+    bucket->next = tk->free_bucket;
+    tk->free_bucket = b;
+}
+
+static void topk_attach(topk_t* tk, uint32_t c, uint32_t b) {
+    topk_counter_t* counter = &tk->counters[c];
+    topk_bucket_t* bucket = &tk->buckets[b];
+
+    counter->bucket = b;
+    counter->prev = TOPK_NIL;
+    counter->next = bucket->head;
+    if (bucket->head != TOPK_NIL) {
+        tk->counters[bucket->head].prev = c;
+    }
+    bucket->head = c;
+}
+
+static void topk_detach(topk_t* tk, uint32_t c) {
+    topk_counter_t* counter = &tk->counters[c];
+    topk_bucket_t* bucket = &tk->buckets[counter->bucket];
+
+    if (counter->prev == TOPK_NIL) {
+        bucket->head = counter->next;
+    } else {
+        tk->counters[counter->prev].next = counter->next;
+    }
+    if (counter->next != TOPK_NIL) {
+        tk->counters[counter->next].prev = counter->prev;
+    }
+}
+
+// move counter c to the bucket of count + 1, creating it right after the current one if needed
+static void topk_increment(topk_t* tk, uint32_t c) {
+    uint32_t b = tk->counters[c].bucket;
+    uint64_t count = tk->buckets[b].count + 1;
+    uint32_t next = tk->buckets[b].next;
+
+    if (next == TOPK_NIL || tk->buckets[next].count != count) {
+        // sole counter of its bucket: the bucket itself moves up without leaving its place in the list
+        if (tk->buckets[b].head == c && tk->counters[c].next == TOPK_NIL) {
+            tk->buckets[b].count = count;
+            return;
+        }
+        next = topk_bucket_new(tk, count, b);
+    }
+
+    topk_detach(tk, c);
+    if (tk->buckets[b].head == TOPK_NIL) {
+        topk_bucket_release(tk, b);
+    }
+    topk_attach(tk, c, next);
+}
+
+int topk_init(topk_t* tk, uint32_t capacity) {
+    memset(tk, 0, sizeof(*tk));
+    if (capacity == 0 || capacity > TOPK_MAX_CAPACITY) {
+        return -1;
+    }
+
+    // index at most half full keeps linear probes short
+    uint32_t index_size = 2;
+    while (index_size < 2 * capacity) {
+        index_size <<= 1;
+    }
+
+    tk->counters = malloc((size_t)capacity * sizeof(topk_counter_t));
+    tk->buckets = malloc(((size_t)capacity + 1) * sizeof(topk_bucket_t));
+    tk->index = calloc(index_size, sizeof(uint32_t));
+    if (!tk->counters || !tk->buckets || !tk->index) {
+        topk_free(tk);
+        return -1;
+    }
+
+    for (uint32_t b = 0; b <= capacity; b++) {
+        tk->buckets[b].next = b < capacity ? b + 1 : TOPK_NIL;
+    }
+    tk->index_mask = index_size - 1;
+    tk->capacity = capacity;
+    tk->min_bucket = TOPK_NIL;
+    tk->free_bucket = 0;
+    return 0;
+}
+
+void topk_free(topk_t* tk) {
+    free(tk->counters);
+    free(tk->buckets);
+    free(tk->index);
+    memset(tk, 0, sizeof(*tk));
+}
+
+void topk_add_hash(topk_t* tk, uint64_t hash) {
+    uint32_t c = topk_find(tk, hash);
+
+    tk->total++;
+    if (c != TOPK_NIL) {
+        topk_increment(tk, c);
+        return;
+    }
+
+    if (tk->size < tk->capacity) {
+        c = tk->size++;
+        tk->counters[c].hash = hash;
+        tk->counters[c].error = 0;
+
+        uint32_t b = tk->min_bucket;
+        if (b == TOPK_NIL || tk->buckets[b].count != 1) {
+            b = topk_bucket_new(tk, 1, TOPK_NIL);
+        }
+        topk_attach(tk, c, b);
+        topk_index_insert(tk, hash, c);
+        return;
+    }
+
+    // replace a minimum counter: the new key inherits its count as error
+    c = tk->buckets[tk->min_bucket].head;
+    topk_index_remove(tk, tk->counters[c].hash);
+    tk->counters[c].hash = hash;
+    tk->counters[c].error = tk->buckets[tk->min_bucket].count;
+    topk_index_insert(tk, hash, c);
+    topk_increment(tk, c);
+}
+
+void topk_add(topk_t* tk, const void* data, size_t len) {
+    topk_add_hash(tk, murmur3_x64_64(data, len, 0));
+}
+
+void topk_add_hash_batch(topk_t* tk, const uint64_t* hashes, size_t n) {
+    for (size_t pos = 0; pos < n; pos += TOPK_BATCH) {
+        size_t len = n - pos < TOPK_BATCH ? n - pos : TOPK_BATCH;
+
+        for (size_t i = 0; i < len; i++) {
+            __builtin_prefetch(&tk->index[(uint32_t)hashes[pos + i] & tk->index_mask]);
+        }
+        for (size_t i = 0; i < len; i++) {
+            topk_add_hash(tk, hashes[pos + i]);
+        }
+    }
+}
+
+typedef struct {
+    topk_t* summaries;
+    size_t nsummaries;
+    const uint64_t* hashes;
+    size_t n;
+} topk_parallel_job_t;
+
+static void topk_parallel_task(void* ctx, size_t task) {
+    topk_parallel_job_t* job = (topk_parallel_job_t*)ctx;
+    size_t begin = job->n * task / job->nsummaries;
+    size_t end = job->n * (task + 1) / job->nsummaries;
+
+    topk_add_hash_batch(&job->summaries[task], job->hashes + begin, end - begin);
+}
+
+void topk_add_hash_parallel(
+    topk_t* summaries, size_t nsummaries, const uint64_t* hashes, size_t n, unsigned nthreads) {
+    topk_parallel_job_t job = { .summaries = summaries, .nsummaries = nsummaries, .hashes = hashes, .n = n };
+    threadpool_run(nsummaries, topk_parallel_task, &job, nthreads);
+}
+
+uint64_t topk_estimate_hash(const topk_t* tk, uint64_t hash) {
+    uint32_t c = topk_find(tk, hash);
+    return c == TOPK_NIL ? 0 : tk->buckets[tk->counters[c].bucket].count;
+}
+
+// walk buckets from the largest count down
+size_t topk_query(const topk_t* tk, topk_item_t* out, size_t k) {
+    size_t n = 0;
+    uint32_t last = tk->min_bucket;
+
+    if (last == TOPK_NIL) {
+        return 0;
+    }
+    while (tk->buckets[last].next != TOPK_NIL) {
+        last = tk->buckets[last].next;
+    }
+
+    for (uint32_t b = last; b != TOPK_NIL && n < k; b = tk->buckets[b].prev) {
+        for (uint32_t c = tk->buckets[b].head; c != TOPK_NIL && n < k; c = tk->counters[c].next) {
+            out[n].hash = tk->counters[c].hash;
+            out[n].count = tk->buckets[b].count;
+            out[n].error = tk->counters[c].error;
+            n++;
+        }
+    }
+    return n;
+}
+
+static int topk_compare_hash(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int topk_compare_count(const void* a, const void* b) {
+    const topk_item_t* x = a;
+    const topk_item_t* y = b;
+    return (x->count < y->count) - (x->count > y->count);
+}
+
+int topk_query_merged(const topk_t* summaries, size_t n, topk_item_t* out, size_t k, size_t* nout) {
+    size_t total = 0;
+
+    *nout = 0;
+    for (size_t s = 0; s < n; s++) {
+        total += summaries[s].size;
+    }
+
+    uint64_t* hashes = malloc((total ? total : 1) * sizeof(uint64_t));
+    topk_item_t* items = malloc((total ? total : 1) * sizeof(topk_item_t));
+    if (!hashes || !items) {
+        free(hashes);
+        free(items);
+        return -1;
+    }
+
+    size_t unique = 0;
+    for (size_t s = 0; s < n; s++) {
+        for (uint32_t c = 0; c < summaries[s].size; c++) {
+            hashes[unique++] = summaries[s].counters[c].hash;
+        }
+    }
+    qsort(hashes, unique, sizeof(uint64_t), topk_compare_hash);
+
+    size_t m = 0;
+    for (size_t i = 0; i < unique; i++) {
+        if (i > 0 && hashes[i] == hashes[i - 1]) {
+            continue;
+        }
+        items[m].hash = hashes[i];
+        items[m].count = 0;
+        items[m].error = 0;
+
+        for (size_t s = 0; s < n; s++) {
+            const topk_t* tk = &summaries[s];
+            uint32_t c = topk_find(tk, hashes[i]);
+
+            if (c != TOPK_NIL) {
+                items[m].count += tk->buckets[tk->counters[c].bucket].count;
+                items[m].error += tk->counters[c].error;
+            } else if (tk->size == tk->capacity) {
+                items[m].count += tk->buckets[tk->min_bucket].count;
+                items[m].error += tk->buckets[tk->min_bucket].count;
+            }
+        }
+        m++;
+    }
+    qsort(items, m, sizeof(topk_item_t), topk_compare_count);
+
+    *nout = m < k ? m : k;
+    memcpy(out, items, *nout * sizeof(topk_item_t));
+    free(hashes);
+    free(items);
+    return 0;
+}
+
+size_t topk_memory(const topk_t* tk) {
+    return (size_t)tk->capacity * sizeof(topk_counter_t) + ((size_t)tk->capacity + 1) * sizeof(topk_bucket_t)
+           + ((size_t)tk->index_mask + 1) * sizeof(uint32_t);
+}
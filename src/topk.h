@@ -0,0 +1,160 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Monitored key reported by a top-k query
+ *
+ * @param hash 64-bit key hash
+ * @param count estimated frequency, never below the true one
+ * @param error overestimation bound, true frequency is at least count - error
+ **/
+typedef struct {
+    uint64_t hash;
+    uint64_t count;
+    uint64_t error;
+} topk_item_t;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t error;
+    uint32_t bucket;
+    uint32_t prev;
+    uint32_t next;
+} topk_counter_t;
+
+typedef struct {
+    uint64_t count;
+    uint32_t head;
+    uint32_t prev;
+    uint32_t next;
+} topk_bucket_t;
+
+/**
+ * @brief Space-Saving heavy hitters summary (stream-summary layout)
+ *
+ * Counters with equal counts share a bucket, buckets form a list sorted by count, so the
+ * minimum counter is found and every unit increment is done in O(1). A linear probing table
+ * maps key hashes to counters. Any key with frequency above total / capacity is monitored.
+ *
+ * @param counters capacity monitored keys
+ * @param buckets distinct counts, at most one per counter
+ * @param index key hash -> counter + 1 (0 = empty slot), power of two size
+ * @param index_mask
+ * @param capacity
+ * @param size monitored keys
+ * @param min_bucket bucket with the smallest count
+ * @param free_bucket head of the unused bucket list
+ * @param total events added
+ **/
+typedef struct {
+    topk_counter_t* counters;
+    topk_bucket_t* buckets;
+    uint32_t* index;
+    uint32_t index_mask;
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t min_bucket;
+    uint32_t free_bucket;
+    uint64_t total;
+} topk_t;
+
+/**
+ * @brief Initialize empty summary
+ *
+ * @param tk
+ * @param capacity monitored keys, 1..2^30
+ * @return int 0 on success, -1 on invalid size or allocation error
+ **/
+int topk_init(topk_t* tk, uint32_t capacity);
+
+/**
+ * @brief Free summary
+ *
+ * @param tk
+ **/
+void topk_free(topk_t* tk);
+
+/**
+ * @brief Add one occurrence of 64-bit hash
+ *
+ * @param tk
+ * @param hash
+ **/
+void topk_add_hash(topk_t* tk, uint64_t hash);
+
+/**
+ * @brief Add one occurrence of byte string (hashed with murmur3_x64_64)
+ *
+ * @param tk
+ * @param data
+ * @param len
+ **/
+void topk_add(topk_t* tk, const void* data, size_t len);
+
+/**
+ * @brief Add one occurrence of many hashes, index slots are prefetched ahead of the updates
+ *
+ * @param tk
+ * @param hashes
+ * @param n
+ **/
+void topk_add_hash_batch(topk_t* tk, const uint64_t* hashes, size_t n);
+
+/**
+ * @brief Split hashes into one contiguous chunk per summary and add each chunk on a thread pool
+ *
+ * @param summaries per-thread summaries, queried together with topk_query_merged
+ * @param nsummaries
+ * @param hashes
+ * @param n
+ * @param nthreads number of workers (0 = all CPUs)
+ **/
+void topk_add_hash_parallel(
+    topk_t* summaries, size_t nsummaries, const uint64_t* hashes, size_t n, unsigned nthreads);
+
+/**
+ * @brief Estimated count of 64-bit hash
+ *
+ * @param tk
+ * @param hash
+ * @return uint64_t count if monitored, 0 otherwise
+ **/
+uint64_t topk_estimate_hash(const topk_t* tk, uint64_t hash);
+
+/**
+ * @brief Most frequent monitored keys, by descending count
+ *
+ * @param tk
+ * @param out up to k items
+ * @param k
+ * @return size_t number of items written
+ **/
+size_t topk_query(const topk_t* tk, topk_item_t* out, size_t k);
+
+/**
+ * @brief Most frequent keys over several summaries without merging them (e.g. one per thread)
+ *
+ * A key missing from a full summary is counted with that summary's minimum, as both count
+ * and error, so the merged counts stay upper bounds.
+ *
+ * @param summaries
+ * @param n number of summaries
+ * @param out up to k items by descending count
+ * @param k
+ * @param nout number of items written
+ * @return int 0 on success, -1 on allocation error
+ **/
+int topk_query_merged(const topk_t* summaries, size_t n, topk_item_t* out, size_t k, size_t* nout);
+
+/**
+ * @brief Memory used by the summary in bytes
+ *
+ * @param tk
+ * @return size_t
+ **/
+size_t topk_memory(const topk_t* tk);
+
+#endif    // TOPK_H
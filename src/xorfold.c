@@ -0,0 +1,149 @@
+#include "xorfold.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "threadpool.h"
+
+// 64-bit words per parallel task (1 MB)
+#define XORFOLD_TASK_WORDS (1u << 17)
+
+typedef struct {
+    const uint8_t* data;
+    size_t nwords;
+    uint64_t* partial;
+} xorfold_job_t;
+
+static inline uint64_t load_u64(const uint8_t* p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// four independent accumulators, so the XORs do not form one dependency chain
+static uint64_t xorfold_words_scalar(const uint8_t* p, size_t nwords) {
+    uint64_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= nwords; i += 4) {
+        acc0 ^= load_u64(p + i * 8);
+        acc1 ^= load_u64(p + i * 8 + 8);
+        acc2 ^= load_u64(p + i * 8 + 16);
+        acc3 ^= load_u64(p + i * 8 + 24);
+    }
+    for (; i < nwords; i++) {
+        acc0 ^= load_u64(p + i * 8);
+    }
+    return acc0 ^ acc1 ^ acc2 ^ acc3;
+}
+
+__attribute__((target("avx2"))) static uint64_t xorfold_words_avx2(const uint8_t* p, size_t nwords) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256();
+    __m256i acc3 = _mm256_setzero_si256();
+    size_t i = 0;
+
+    // 128 bytes per iteration in four accumulators
+    for (; i + 16 <= nwords; i += 16) {
+        acc0 = _mm256_xor_si256(acc0, _mm256_loadu_si256((const __m256i*)(p + i * 8)));
+        acc1 = _mm256_xor_si256(acc1, _mm256_loadu_si256((const __m256i*)(p + i * 8 + 32)));
+        acc2 = _mm256_xor_si256(acc2, _mm256_loadu_si256((const __m256i*)(p + i * 8 + 64)));
+        acc3 = _mm256_xor_si256(acc3, _mm256_loadu_si256((const __m256i*)(p + i * 8 + 96)));
+    }
+
+    acc0 = _mm256_xor_si256(_mm256_xor_si256(acc0, acc1), _mm256_xor_si256(acc2, acc3));
+    for (; i + 4 <= nwords; i += 4) {
+        acc0 = _mm256_xor_si256(acc0, _mm256_loadu_si256((const __m256i*)(p + i * 8)));
+    }
+
+    __m128i half = _mm_xor_si128(_mm256_castsi256_si128(acc0), _mm256_extracti128_si256(acc0, 1));
+    uint64_t result = (uint64_t)_mm_cvtsi128_si64(half) ^ (uint64_t)_mm_extract_epi64(half, 1);
+
+    for (; i < nwords; i++) {
+        result ^= load_u64(p + i * 8);
+    }
+    return result;
+}
+
+static uint64_t xorfold_words(const uint8_t* p, size_t nwords) {
+    if (__builtin_cpu_supports("avx2")) {
+        return xorfold_words_avx2(p, nwords);
+    }
+    return xorfold_words_scalar(p, nwords);
+}
+
+static void xorfold_task(void* ctx, size_t task) {
+    xorfold_job_t* job = (xorfold_job_t*)ctx;
+    size_t first = task * XORFOLD_TASK_WORDS;
+    size_t n = job->nwords - first < XORFOLD_TASK_WORDS ? job->nwords - first : XORFOLD_TASK_WORDS;
+
+    job->partial[task] = xorfold_words(job->data + first * 8, n);
+}
+
+static uint64_t xorfold_words_parallel(const uint8_t* p, size_t nwords, unsigned nthreads) {
+    size_t ntasks = (nwords + XORFOLD_TASK_WORDS - 1) / XORFOLD_TASK_WORDS;
+
+    if (nwords * 8 < XORFOLD_PARALLEL_THRESHOLD) {
+        return xorfold_words(p, nwords);
+    }
+
+    xorfold_job_t job = { .data = p, .nwords = nwords, .partial = malloc(ntasks * sizeof(uint64_t)) };
+    if (!job.partial) {
+        return xorfold_words(p, nwords);
+    }
+
+    threadpool_run(ntasks, xorfold_task, &job, nthreads);
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < ntasks; i++) {
+        result ^= job.partial[i];
+    }
+    free(job.partial);
+    return result;
+}
+
+// pairs of 32-bit words are folded as one 64-bit word, halves are merged at the end
+static uint32_t xor_fold_halves(const uint32_t* data, size_t len, uint64_t pairs) {
+    uint32_t result = (uint32_t)pairs ^ (uint32_t)(pairs >> 32);
+
+    if (len & 1) {
+        result ^= data[len - 1];
+    }
+    return result;
+}
+
+uint32_t xor_fold(const uint32_t* data, size_t len) {
+    return xor_fold_halves(data, len, xorfold_words((const uint8_t*)data, len / 2));
+}
+
+uint64_t xor_fold64(const uint64_t* data, size_t len) {
+    return xorfold_words((const uint8_t*)data, len);
+}
+
+uint8_t xor_fold8(const uint8_t* data, size_t len) {
+    uint64_t r = xorfold_words(data, len / 8);
+    r ^= r >> 32;
+    r ^= r >> 16;
+    r ^= r >> 8;
+
+    uint8_t result = (uint8_t)r;
+    for (size_t i = len & ~(size_t)7; i < len; i++) {
+        result ^= data[i];
+    }
+    return result;
+}
+
+int xor_parity(const uint8_t* data, size_t len) {
+    return __builtin_parity(xor_fold8(data, len));
+}
+
+uint32_t xor_fold_parallel(const uint32_t* data, size_t len, unsigned nthreads) {
+    return xor_fold_halves(data, len, xorfold_words_parallel((const uint8_t*)data, len / 2, nthreads));
+}
+
+uint64_t xor_fold64_parallel(const uint64_t* data, size_t len, unsigned nthreads) {
+    return xorfold_words_parallel((const uint8_t*)data, len, nthreads);
+}
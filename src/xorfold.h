@@ -0,0 +1,66 @@
+#ifndef XORFOLD_H
+#define XORFOLD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// arrays above this size are worth splitting across threads
+#define XORFOLD_PARALLEL_THRESHOLD (4u << 20)
+
+/**
+ * @brief XOR-fold array of 32-bit words into one word
+ *
+ * @param data
+ * @param len number of words
+ * @return uint32_t
+ **/
+uint32_t xor_fold(const uint32_t* data, size_t len);
+
+/**
+ * @brief XOR-fold array of 64-bit words into one word
+ *
+ * @param data
+ * @param len number of words
+ * @return uint64_t
+ **/
+uint64_t xor_fold64(const uint64_t* data, size_t len);
+
+/**
+ * @brief XOR-fold bytes into one byte (longitudinal redundancy check)
+ *
+ * @param data
+ * @param len number of bytes
+ * @return uint8_t
+ **/
+uint8_t xor_fold8(const uint8_t* data, size_t len);
+
+/**
+ * @brief Parity of all bits in a buffer
+ *
+ * @param data
+ * @param len number of bytes
+ * @return int 1 if number of set bits is odd
+ **/
+int xor_parity(const uint8_t* data, size_t len);
+
+/**
+ * @brief XOR-fold 32-bit words, splitting big arrays across threads
+ *
+ * @param data
+ * @param len number of words
+ * @param nthreads number of workers (0 = all CPUs)
+ * @return uint32_t
+ **/
+uint32_t xor_fold_parallel(const uint32_t* data, size_t len, unsigned nthreads);
+
+/**
+ * @brief XOR-fold 64-bit words, splitting big arrays across threads
+ *
+ * @param data
+ * @param len number of words
+ * @param nthreads number of workers (0 = all CPUs)
+ * @return uint64_t
+ **/
+uint64_t xor_fold64_parallel(const uint64_t* data, size_t len, unsigned nthreads);
+
+#endif    // XORFOLD_H